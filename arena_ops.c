@@ -0,0 +1,80 @@
+// arena_ops.c
+// Arena (slab) allocation
+
+// Handles the following:
+// - Creating an arena
+// - Handing out memory from contiguous slabs
+// - Freeing every allocation of an arena in one go
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "arena_ops.h"
+#include "stats_ops.h"
+
+// Every allocation is rounded up to this many bytes so that doubles
+// and pointers stay aligned
+#define ARENA_ALIGN 8
+// Slabs double in size up to this limit
+#define ARENA_MAX_SLAB (16 << 20)
+
+// Returns pointer to a new arena whose first slab holds first_size bytes
+arena_t *CreateArena(size_t first_size) {
+    arena_t *arena;
+    if ( (arena = (arena_t*)malloc(sizeof(arena_t))) == NULL ) {
+        printf("malloc() error\n");
+        exit(EXIT_FAILURE);
+    }
+    arena->head = NULL;
+    arena->next_size = first_size > 0 ? first_size : ARENA_ALIGN;
+    arena->bytes = 0;
+    return arena;
+}
+
+// Adds a slab big enough for at least "bytes" bytes to the front of the chain
+static void AddSlab(arena_t *arena, size_t bytes) {
+    size_t size = arena->next_size;
+    while (size < bytes) {
+        size*=2;
+    }
+    if (arena->next_size < ARENA_MAX_SLAB) {
+        arena->next_size*=2;
+    }
+
+    slab_t *slab;
+    if ( (slab = (slab_t*)malloc(sizeof(slab_t))) == NULL ||
+         (slab->data = (char*)malloc(size)) == NULL ) {
+        printf("malloc() error\n");
+        exit(EXIT_FAILURE);
+    }
+    STAT_ADD(heap_allocs, 2);
+    STAT_ADD(heap_bytes, sizeof(slab_t) + size);
+    slab->prev = arena->head;
+    slab->used = 0;
+    slab->size = size;
+    arena->head = slab;
+    arena->bytes += size;
+}
+
+// Returns pointer to "bytes" bytes of uninitialised memory owned by the arena
+void *ArenaAlloc(arena_t *arena, size_t bytes) {
+    bytes = (bytes + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+    if (arena->head == NULL || arena->head->used + bytes > arena->head->size) {
+        AddSlab(arena, bytes);
+    }
+    void *p = arena->head->data + arena->head->used;
+    arena->head->used += bytes;
+    STAT_ADD(arena_allocs, 1);
+    return p;
+}
+
+// Frees every slab, and with them every allocation made from the arena
+void FreeArena(arena_t *arena) {
+    slab_t *slab = arena->head;
+    while (slab) {
+        slab_t *prev = slab->prev;
+        free(slab->data);
+        free(slab);
+        slab = prev;
+    }
+    free(arena);
+}
@@ -0,0 +1,30 @@
+#ifndef ARENA_OPS_H
+#define ARENA_OPS_H
+
+#include <stddef.h>
+
+// A slab is one contiguous block of memory handed out piece by piece
+typedef struct slab slab_t;
+
+struct slab {
+    slab_t *prev;
+    size_t used;
+    size_t size;
+    char *data;
+};
+
+// An arena owns a chain of slabs, newest first.
+// Everything allocated from it is released together by FreeArena.
+typedef struct {
+    slab_t *head;
+    size_t next_size;
+    size_t bytes;
+} arena_t;
+
+arena_t *CreateArena(size_t first_size);
+
+void *ArenaAlloc(arena_t *arena, size_t bytes);
+
+void FreeArena(arena_t *arena);
+
+#endif
@@ -0,0 +1,147 @@
+// batch_ops.c
+// Classifies many watchtower files against one built DCEL
+
+// Handles the following:
+// - Reading the list of jobs, one "watchtowers.csv output.txt" pair per line
+// - Running the jobs on a pool of threads, each taking the next job not yet
+//       started until none are left
+// The DCEL and the grid over its faces are built once and only read by the
+// jobs, so every job shares them and only loads and classifies its own file.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "batch_ops.h"
+#include "wt_ops.h"
+#include "output_ops.h"
+
+#define B_START_SIZE 16
+// Longest file name accepted in the job list
+#define MAX_PATH_LEN 4096
+
+// State shared by every thread of a batch
+typedef struct {
+    batch_t *batch;
+    face_grid_t *grid;
+    frozen_dcel_t *frozen;
+    // next job to be taken
+    int next;
+    // jobs whose input could not be read or output could not be written
+    int failed;
+} batch_work_t;
+
+static char *CopyString(const char *s) {
+    char *copy;
+    if ( (copy = (char*)malloc(strlen(s)+1)) == NULL ) {
+        printf("malloc() error\n");
+        exit(EXIT_FAILURE);
+    }
+    strcpy(copy, s);
+    return copy;
+}
+
+// Reads pairs of file names until the end of the file, or until a name is
+// left without its pair
+batch_t *ReadBatch(FILE *file) {
+    batch_t *batch;
+    if ( (batch = (batch_t*)malloc(sizeof(batch_t))) == NULL ||
+         (batch->inputs = (char**)malloc(sizeof(char*)*B_START_SIZE)) == NULL ||
+         (batch->outputs = (char**)malloc(sizeof(char*)*B_START_SIZE)) == NULL ) {
+        printf("malloc() error\n");
+        exit(EXIT_FAILURE);
+    }
+    batch->num = 0;
+    batch->size = B_START_SIZE;
+
+    char input[MAX_PATH_LEN], output[MAX_PATH_LEN];
+    while (fscanf(file, "%4095s %4095s", input, output) == 2) {
+        if (batch->num == batch->size) {
+            batch->size*=2;
+            if ( (batch->inputs = (char**)
+                 realloc(batch->inputs, sizeof(char*)*batch->size)) == NULL ||
+                 (batch->outputs = (char**)
+                 realloc(batch->outputs, sizeof(char*)*batch->size)) == NULL ) {
+                printf("realloc() error\n");
+                exit(EXIT_FAILURE);
+            }
+        }
+        batch->inputs[batch->num] = CopyString(input);
+        batch->outputs[batch->num] = CopyString(output);
+        batch->num++;
+    }
+    return batch;
+}
+
+// Thread body: loads, classifies and prints jobs until none are left
+static void *RunJobs(void *arg) {
+    batch_work_t *work = (batch_work_t*)arg;
+    batch_t *batch = work->batch;
+    int i;
+    while ((i = __atomic_fetch_add(&work->next, 1, __ATOMIC_RELAXED)) < batch->num) {
+        wt_table_t *wts;
+        if ((wts = MapWtFile(batch->inputs[i], 1)) == NULL) {
+            fprintf(stderr, "Batch input %s not found\n", batch->inputs[i]);
+            __atomic_fetch_add(&work->failed, 1, __ATOMIC_RELAXED);
+            continue;
+        }
+        FILE *file;
+        if ((file = fopen(batch->outputs[i], "w")) == NULL) {
+            fprintf(stderr, "Batch output %s could not be written\n", batch->outputs[i]);
+            __atomic_fetch_add(&work->failed, 1, __ATOMIC_RELAXED);
+            FreeWts(wts);
+            continue;
+        }
+        GridOutput(file, work->grid, work->frozen, wts, 1);
+        fclose(file);
+        FreeWts(wts);
+    }
+    return NULL;
+}
+
+//==============================================================================
+// Runs every job of the batch against the frozen DCEL through its face grid, with
+// up to "jobs" files being worked on at once. Each file's output is the same
+// as a single run over it would write.
+// Returns the number of jobs which failed.
+//==============================================================================
+int RunBatch(batch_t *batch, face_grid_t *grid, frozen_dcel_t *frozen, int jobs) {
+    batch_work_t work = {batch, grid, frozen, 0, 0};
+    if (jobs > batch->num) {
+        jobs = batch->num;
+    }
+    if (jobs < 1) {
+        jobs = 1;
+    }
+    pthread_t *ids;
+    if ( (ids = (pthread_t*)malloc(sizeof(pthread_t)*jobs)) == NULL ) {
+        printf("malloc() error\n");
+        exit(EXIT_FAILURE);
+    }
+
+    // the calling thread works too, as thread 0
+    int t;
+    for (t=1;t<jobs;t++) {
+        if (pthread_create(&ids[t], NULL, RunJobs, &work) != 0) {
+            printf("pthread_create() error\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    RunJobs(&work);
+    for (t=1;t<jobs;t++) {
+        pthread_join(ids[t], NULL);
+    }
+    free(ids);
+    return work.failed;
+}
+
+void FreeBatch(batch_t *batch) {
+    int i;
+    for (i=0;i<batch->num;i++) {
+        free(batch->inputs[i]);
+        free(batch->outputs[i]);
+    }
+    free(batch->inputs);
+    free(batch->outputs);
+    free(batch);
+}
@@ -0,0 +1,23 @@
+#ifndef BATCH_OPS_H
+#define BATCH_OPS_H
+
+#include <stdio.h>
+#include "locate_ops.h"
+#include "frozen_ops.h"
+
+// A list of watchtower files, each to be classified against the same DCEL,
+// with job i reading inputs[i] and writing outputs[i]
+typedef struct {
+    int num;
+    int size;
+    char **inputs;
+    char **outputs;
+} batch_t;
+
+batch_t *ReadBatch(FILE *file);
+
+int RunBatch(batch_t *batch, face_grid_t *grid, frozen_dcel_t *frozen, int jobs);
+
+void FreeBatch(batch_t *batch);
+
+#endif
@@ -0,0 +1,634 @@
+// bench.c
+// Benchmarks the stages of voronoi1 on synthetic inputs
+
+// Usage: voronoi1_bench [max_watchtowers] [max_splits]
+//
+// Generates a polygon, random split sequences and random watchtower files,
+// then times the following separately at growing sizes:
+// - ReadWtInfo and MapWtFile loading a watchtower csv into a table
+// - FirstPolygon building a polygon, for both DCEL layouts
+// - SplitFace replaying a split sequence, for both DCEL layouts
+// - BuildFlatDcel building a subdivision in one go, against FlatFirstPolygon
+//       followed by FlatApplySplits, with splits cutting edges anywhere
+// - ClassifyWtsInOrder classifying watchtowers face by face, watchtower by
+//       watchtower, and choosing per grid cell
+// - CreateOutput classifying and printing watchtowers, for both DCEL layouts
+// - ClassifyWts against a single notched face of growing size, which takes
+//       the winding number check
+// - FlatSplitFace with no order against FlatApplySplits cutting corners off
+//       a polygon of growing size, so the side after M-->B is always large
+// Every case runs in its own child process so its peak RSS can be measured.
+// Inputs come from a fixed seed, so reports can be compared across commits.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include "wt_ops.h"
+#include "dcel_ops.h"
+#include "flat_ops.h"
+#include "split_ops.h"
+#include "output_ops.h"
+#include "classify_ops.h"
+#include "frozen_ops.h"
+
+#define DEFAULT_MAX_WTS 10000000
+#define DEFAULT_MAX_SPLITS 1000000
+// Watchtowers and splits start at these sizes and grow tenfold
+#define MIN_WTS 1000
+#define MIN_SPLITS 100
+#define MIN_POLYGON 100
+#define MAX_POLYGON 100000
+// Most corners cut off one polygon, each costing a pass round it without order
+#define MAX_CORNERS 10000
+// Vertices of the polygon that splits and watchtowers use
+#define BASE_POLYGON 64
+// Splits made before timing CreateOutput
+#define OUTPUT_SPLITS 10000
+#define SEED 20003
+
+// Result of one timed case, passed from the child back to the parent
+typedef struct {
+    double seconds;
+    long ops;
+} timing_t;
+
+// Inputs shared by every case, generated once before any case runs
+typedef struct {
+    char polygon_path[64];
+    char wts_path[64];
+    splits_t *splits;
+    long size;
+    int flat;
+    // loop order for classification, one of the ORDER_ values
+    int loop;
+} bench_t;
+
+typedef timing_t (*case_t)(bench_t *bench);
+
+static double Now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Uniform random double in [lo, hi)
+static double Uniform(double lo, double hi) {
+    return lo + (hi - lo) * (rand() / (RAND_MAX + 1.0));
+}
+
+//==============================================================================
+// Input generation
+//==============================================================================
+
+// Writes a regular polygon with n vertices, oriented clockwise, on a circle
+// of radius 5 around (145, -37)
+static void WritePolygon(char *path, int n) {
+    FILE *file = fopen(path, "w");
+    int i;
+    for (i=0;i<n;i++) {
+        double angle = -2 * M_PI * i / n;
+        fprintf(file, "%.17g %.17g\n", 145 + 5*cos(angle), -37 + 5*sin(angle));
+    }
+    fclose(file);
+}
+
+// Writes a regular polygon with n notches, oriented clockwise on a circle of
+// radius 5 around (145, -37). Every other vertex is pulled in by about the
+// width of a notch, so half the vertices are reflex but a horizontal line
+// still only crosses a few edges.
+static void WriteNotched(char *path, int n) {
+    FILE *file = fopen(path, "w");
+    int i;
+    for (i=0;i<2*n;i++) {
+        double angle = -M_PI * i / n;
+        double r = i % 2 ? 5 - 20.0 / n : 5;
+        fprintf(file, "%.17g %.17g\n", 145 + r*cos(angle), -37 + r*sin(angle));
+    }
+    fclose(file);
+}
+
+// Writes n watchtowers spread uniformly over the polygon's bounding box
+static void WriteWts(char *path, long n) {
+    FILE *file = fopen(path, "w");
+    long i;
+    fprintf(file, "Watchtower ID,Postcode,Population Served,"
+        "Watchtower Point of Contact Name,x,y\n");
+    for (i=0;i<n;i++) {
+        fprintf(file, "WT%07ld,%ld,%d,Contact %ld,%.15g,%.15g\n", i, 3000 + i%1000,
+            rand() % 100000, i % 9973, Uniform(140, 150), Uniform(-42, -32));
+    }
+    fclose(file);
+}
+
+// Returns k random splits valid for the polygon in path. Each split picks a
+// random face and two of its edges, and is only kept if the midpoint of the
+// two cut points lies strictly inside the face, which rules out splitting
+// along a straight line. The edges are bisected, or with cut set, cut at
+// random points away from their ends.
+static splits_t *MakeSplits(char *path, int k, int cut) {
+    FILE *file = fopen(path, "r");
+    flat_dcel_t *dcel = CreateFlatDcel();
+    FlatFirstPolygon(dcel, file);
+    fclose(file);
+    FlatReserveDcel(dcel, dcel->num_vertex + 2*k, 1 + k, dcel->num_hedge + 6*k);
+
+    splits_t *splits;
+    if ( (splits = (splits_t*)malloc(sizeof(splits_t))) == NULL ||
+         (splits->pairs = (int*)malloc(sizeof(int)*(2*k+1))) == NULL ) {
+        printf("malloc() error\n");
+        exit(EXIT_FAILURE);
+    }
+    splits->size = 2*k+1;
+    splits->num = 0;
+    splits->at = NULL;
+    if (cut && (splits->at = (double*)malloc(sizeof(double)*(2*k+1))) == NULL) {
+        printf("malloc() error\n");
+        exit(EXIT_FAILURE);
+    }
+
+    int size_face_edges = 64;
+    int *face_hedges = (int*)malloc(sizeof(int)*size_face_edges);
+    while (splits->num < 2*k) {
+        int f = rand() % dcel->num_face;
+        int start = dcel->face_hedge[f];
+        int h = start, n = 0;
+        do {
+            if (n == size_face_edges) {
+                size_face_edges*=2;
+                face_hedges = (int*)realloc(face_hedges, sizeof(int)*size_face_edges);
+            }
+            face_hedges[n++] = h;
+            h = dcel->h_next[h];
+        } while (h != start);
+
+        int a = rand() % n;
+        int b = rand() % (n-1);
+        if (b >= a) {
+            b++;
+        }
+        int ha = face_hedges[a], hb = face_hedges[b];
+        // P is worked out exactly as the split will work it out, so the
+        // split is sure to pick the same face
+        double ta = 0.5, tb = 0.5, Mx, My, Nx, Ny;
+        if (cut) {
+            // cut points are measured along each edge's first half-edge
+            int ea = 2*FLAT_EDGE(ha), eb = 2*FLAT_EDGE(hb);
+            double Ax = dcel->xs[dcel->h_start[ea]], Ay = dcel->ys[dcel->h_start[ea]];
+            double Cx = dcel->xs[dcel->h_start[eb]], Cy = dcel->ys[dcel->h_start[eb]];
+            ta = Uniform(0.1, 0.9);
+            tb = Uniform(0.1, 0.9);
+            Mx = Ax + ta * (dcel->xs[FLAT_END(dcel, ea)] - Ax);
+            My = Ay + ta * (dcel->ys[FLAT_END(dcel, ea)] - Ay);
+            Nx = Cx + tb * (dcel->xs[FLAT_END(dcel, eb)] - Cx);
+            Ny = Cy + tb * (dcel->ys[FLAT_END(dcel, eb)] - Cy);
+        } else {
+            Mx = (dcel->xs[dcel->h_start[ha]] + dcel->xs[FLAT_END(dcel, ha)]) / 2;
+            My = (dcel->ys[dcel->h_start[ha]] + dcel->ys[FLAT_END(dcel, ha)]) / 2;
+            Nx = (dcel->xs[dcel->h_start[hb]] + dcel->xs[FLAT_END(dcel, hb)]) / 2;
+            Ny = (dcel->ys[dcel->h_start[hb]] + dcel->ys[FLAT_END(dcel, hb)]) / 2;
+        }
+        double Px = (Mx + Nx) / 2;
+        double Py = (My + Ny) / 2;
+        if (!FlatHalfPlane(dcel, dcel->h_start[ha], FLAT_END(dcel, ha), Px, Py) ||
+            !FlatHalfPlane(dcel, dcel->h_start[hb], FLAT_END(dcel, hb), Px, Py)) {
+            continue;
+        }
+        if (cut) {
+            splits->at[splits->num] = ta;
+            splits->at[splits->num+1] = tb;
+            FlatSplitFaceAt(dcel, FLAT_EDGE(ha), ta, FLAT_EDGE(hb), tb, NULL);
+        } else {
+            FlatSplitFace(dcel, FLAT_EDGE(ha), FLAT_EDGE(hb), NULL);
+        }
+        splits->pairs[splits->num++] = FLAT_EDGE(ha);
+        splits->pairs[splits->num++] = FLAT_EDGE(hb);
+    }
+
+    free(face_hedges);
+    FreeFlatDcel(dcel);
+    return splits;
+}
+
+// Returns k splits which cut corners off a polygon written by WritePolygon
+// with 4k vertices one after another, each between edges 4i and 4i+2, which
+// no earlier split has touched. Each pair puts the later edge first, so the
+// side after M-->B is everything but the corner.
+static splits_t *MakeCornerSplits(int k) {
+    splits_t *splits;
+    if ( (splits = (splits_t*)malloc(sizeof(splits_t))) == NULL ||
+         (splits->pairs = (int*)malloc(sizeof(int)*(2*k+1))) == NULL ) {
+        printf("malloc() error\n");
+        exit(EXIT_FAILURE);
+    }
+    splits->size = 2*k+1;
+    splits->num = 2*k;
+    splits->at = NULL;
+    int i;
+    for (i=0;i<k;i++) {
+        splits->pairs[2*i] = 4*i+2;
+        splits->pairs[2*i+1] = 4*i;
+    }
+    return splits;
+}
+
+//==============================================================================
+// Cases, each run in a child process
+//==============================================================================
+
+static timing_t ReadCase(bench_t *bench) {
+    timing_t t;
+    FILE *file = fopen(bench->wts_path, "r");
+    double start = Now();
+    wt_table_t *wts = ReadWtInfo(file);
+    t.seconds = Now() - start;
+    t.ops = wts->n;
+    fclose(file);
+    FreeWts(wts);
+    return t;
+}
+
+static timing_t MapCase(bench_t *bench) {
+    timing_t t;
+    double start = Now();
+    wt_table_t *wts = MapWtFile(bench->wts_path, 1);
+    t.seconds = Now() - start;
+    t.ops = wts->n;
+    FreeWts(wts);
+    return t;
+}
+
+static timing_t PolygonCase(bench_t *bench) {
+    timing_t t;
+    FILE *file = fopen(bench->polygon_path, "r");
+    double start = Now();
+    if (bench->flat) {
+        flat_dcel_t *dcel = CreateFlatDcel();
+        FlatFirstPolygon(dcel, file);
+        t.seconds = Now() - start;
+        t.ops = dcel->num_vertex;
+        FreeFlatDcel(dcel);
+    } else {
+        dcel_t *dcel = CreateDcel();
+        FirstPolygon(dcel, file);
+        t.seconds = Now() - start;
+        t.ops = dcel->num_vertex;
+        FreeDcel(dcel);
+    }
+    fclose(file);
+    return t;
+}
+
+// Replays the first "size" splits
+static timing_t SplitCase(bench_t *bench) {
+    timing_t t;
+    FILE *file = fopen(bench->polygon_path, "r");
+    splits_t part = *bench->splits;
+    part.num = 2*bench->size;
+    if (bench->flat) {
+        flat_dcel_t *dcel = CreateFlatDcel();
+        FlatFirstPolygon(dcel, file);
+        double start = Now();
+        t.ops = FlatApplySplits(dcel, &part);
+        t.seconds = Now() - start;
+        FreeFlatDcel(dcel);
+    } else {
+        dcel_t *dcel = CreateDcel();
+        FirstPolygon(dcel, file);
+        double start = Now();
+        t.ops = ApplySplits(dcel, &part);
+        t.seconds = Now() - start;
+        FreeDcel(dcel);
+    }
+    fclose(file);
+    return t;
+}
+
+// Builds the polygon and performs the first "size" splits, either in one go
+// (bench->flat set) or one split at a time on a DCEL grown as it goes
+static timing_t BuildCase(bench_t *bench) {
+    timing_t t;
+    FILE *file = fopen(bench->polygon_path, "r");
+    splits_t part = *bench->splits;
+    part.num = 2*bench->size;
+    double start = Now();
+    flat_dcel_t *dcel;
+    if (bench->flat) {
+        int done;
+        dcel = BuildFlatDcel(file, &part, &done);
+        t.ops = done;
+    } else {
+        dcel = CreateFlatDcel();
+        FlatFirstPolygon(dcel, file);
+        t.ops = FlatApplySplits(dcel, &part);
+    }
+    t.seconds = Now() - start;
+    FreeFlatDcel(dcel);
+    fclose(file);
+    return t;
+}
+
+// Classifies the watchtower file against the frozen polygon after all the
+// splits in the given loop order, without printing anything
+static timing_t ClassifyCase(bench_t *bench) {
+    timing_t t;
+    FILE *file = fopen(bench->polygon_path, "r");
+    wt_table_t *wts = MapWtFile(bench->wts_path, 1);
+    int done;
+    flat_dcel_t *dcel = BuildFlatDcel(file, bench->splits, &done);
+    face_grid_t *grid = CreateFlatFaceGrid(dcel);
+    frozen_dcel_t *frozen = FreezeFlatDcel(dcel);
+    matches_t matches = {0, 0, NULL, NULL};
+    double start = Now();
+    ClassifyWtsInOrder(grid, frozen, wts, 1, bench->loop, &matches);
+    t.seconds = Now() - start;
+    t.ops = wts->n;
+    free(matches.face);
+    free(matches.wt);
+    FreeFrozenDcel(frozen);
+    FreeFaceGrid(grid);
+    FreeFlatDcel(dcel);
+    FreeWts(wts);
+    fclose(file);
+    return t;
+}
+
+// Classifies the watchtower file against the polygon after all the splits,
+// printing to /dev/null
+static timing_t OutputCase(bench_t *bench) {
+    timing_t t;
+    FILE *file = fopen(bench->polygon_path, "r");
+    FILE *out = fopen("/dev/null", "w");
+    wt_table_t *wts = MapWtFile(bench->wts_path, 1);
+    t.ops = wts->n;
+    if (bench->flat) {
+        flat_dcel_t *dcel = CreateFlatDcel();
+        FlatFirstPolygon(dcel, file);
+        FlatApplySplits(dcel, bench->splits);
+        double start = Now();
+        FlatCreateOutput(out, dcel, wts, 1);
+        t.seconds = Now() - start;
+        FreeFlatDcel(dcel);
+    } else {
+        dcel_t *dcel = CreateDcel();
+        FirstPolygon(dcel, file);
+        ApplySplits(dcel, bench->splits);
+        double start = Now();
+        CreateOutput(out, dcel, wts, 1);
+        t.seconds = Now() - start;
+        FreeDcel(dcel);
+    }
+    FreeWts(wts);
+    fclose(out);
+    fclose(file);
+    return t;
+}
+
+// Performs all the splits, either with FlatApplySplits (bench->flat set),
+// which keeps an order and relabels the smaller side of each, or one at a
+// time with FlatSplitFace and no order, which relabels the side after M-->B
+static timing_t CornerCase(bench_t *bench) {
+    timing_t t;
+    FILE *file = fopen(bench->polygon_path, "r");
+    flat_dcel_t *dcel = CreateFlatDcel();
+    FlatFirstPolygon(dcel, file);
+    double start = Now();
+    if (bench->flat) {
+        t.ops = FlatApplySplits(dcel, bench->splits);
+    } else {
+        int i;
+        t.ops = 0;
+        for (i=0;i<bench->splits->num/2;i++) {
+            t.ops += FlatSplitFace(dcel, bench->splits->pairs[2*i],
+                bench->splits->pairs[2*i+1], NULL) >= 0;
+        }
+    }
+    t.seconds = Now() - start;
+    FreeFlatDcel(dcel);
+    fclose(file);
+    return t;
+}
+
+//==============================================================================
+// Running and reporting
+//==============================================================================
+
+// Runs one case in a child process and prints its report line.
+// prev holds the previous size's timing for the same stage, or has no ops,
+// and is used to estimate how the time per stage scales with size.
+static timing_t RunCase(char *name, case_t fn, bench_t *bench, timing_t *prev, long prev_size) {
+    int fds[2];
+    timing_t t = {0, 0};
+    fflush(stdout);
+    if (pipe(fds) < 0) {
+        printf("pipe() error\n");
+        exit(EXIT_FAILURE);
+    }
+    pid_t pid = fork();
+    if (pid == 0) {
+        close(fds[0]);
+        t = fn(bench);
+        if (write(fds[1], &t, sizeof(t)) != sizeof(t)) {
+            _exit(EXIT_FAILURE);
+        }
+        _exit(EXIT_SUCCESS);
+    }
+    close(fds[1]);
+    int status;
+    struct rusage usage;
+    int got = read(fds[0], &t, sizeof(t)) == sizeof(t);
+    close(fds[0]);
+    wait4(pid, &status, 0, &usage);
+    if (!got) {
+        printf("%-22s %10ld  failed\n", name, bench->size);
+        return t;
+    }
+
+    double ns_per_op = t.ops ? t.seconds * 1e9 / t.ops : 0;
+    printf("%-22s %10ld %12.3f %12.1f %10.1f", name, bench->size,
+        t.seconds * 1e3, ns_per_op, usage.ru_maxrss / 1024.0);
+    // time grows as size^exponent between this size and the last
+    if (prev->ops > 0 && prev->seconds > 0 && t.seconds > 0 && prev_size != bench->size) {
+        printf("   n^%.2f", log(t.seconds / prev->seconds) / log((double)bench->size / prev_size));
+    }
+    printf("\n");
+    return t;
+}
+
+// Next size in a tenfold sequence ending exactly at max
+static long NextSize(long size, long max) {
+    if (size >= max) {
+        return 0;
+    }
+    return size*10 < max ? size*10 : max;
+}
+
+static void Header(char *title) {
+    printf("\n%s\n", title);
+    printf("%-22s %10s %12s %12s %10s   %s\n",
+        "stage", "size", "total ms", "ns/op", "peak MB", "scaling");
+}
+
+int main(int argc, char **argv) {
+    long max_wts = argc > 1 ? atol(argv[1]) : DEFAULT_MAX_WTS;
+    long max_splits = argc > 2 ? atol(argv[2]) : DEFAULT_MAX_SPLITS;
+    if (max_wts < MIN_WTS) {
+        max_wts = MIN_WTS;
+    }
+    if (max_splits < MIN_SPLITS) {
+        max_splits = MIN_SPLITS;
+    }
+    srand(SEED);
+
+    bench_t bench;
+    strcpy(bench.polygon_path, "/tmp/voronoi1_bench_polyXXXXXX");
+    strcpy(bench.wts_path, "/tmp/voronoi1_bench_wtsXXXXXX");
+    int fd;
+    if ((fd = mkstemp(bench.polygon_path)) < 0) {
+        printf("mkstemp() error\n");
+        exit(EXIT_FAILURE);
+    }
+    close(fd);
+    if ((fd = mkstemp(bench.wts_path)) < 0) {
+        printf("mkstemp() error\n");
+        exit(EXIT_FAILURE);
+    }
+    close(fd);
+
+    printf("voronoi1 benchmark: up to %ld watchtowers and %ld splits, seed %d\n",
+        max_wts, max_splits, SEED);
+    printf("ns/op is per watchtower, polygon vertex or split; "
+        "scaling is the growth of total time against size\n");
+
+    long size, prev_size;
+    timing_t prev[2];
+    int flat;
+
+    // polygon construction
+    Header("FirstPolygon (op = vertex)");
+    for (flat=0;flat<2;flat++) {
+        prev[flat].ops = 0;
+        prev_size = 0;
+        for (size=MIN_POLYGON;size;size=NextSize(size, MAX_POLYGON)) {
+            WritePolygon(bench.polygon_path, size);
+            bench.size = size;
+            bench.flat = flat;
+            prev[flat] = RunCase(flat ? "FlatFirstPolygon" : "FirstPolygon",
+                PolygonCase, &bench, &prev[flat], prev_size);
+            prev_size = size;
+        }
+    }
+
+    // split replay, every size replays a prefix of one long sequence
+    WritePolygon(bench.polygon_path, BASE_POLYGON);
+    double start = Now();
+    bench.splits = MakeSplits(bench.polygon_path, max_splits, 0);
+    printf("\n(generated %ld splits in %.2f s)\n", max_splits, Now() - start);
+    Header("SplitFace (op = split)");
+    for (flat=0;flat<2;flat++) {
+        prev[flat].ops = 0;
+        prev_size = 0;
+        for (size=MIN_SPLITS;size;size=NextSize(size, max_splits)) {
+            bench.size = size;
+            bench.flat = flat;
+            prev[flat] = RunCase(flat ? "FlatSplitFace" : "SplitFace",
+                SplitCase, &bench, &prev[flat], prev_size);
+            prev_size = size;
+        }
+    }
+
+    // whole subdivisions, with the edges cut at random points
+    FreeSplits(bench.splits);
+    start = Now();
+    bench.splits = MakeSplits(bench.polygon_path, max_splits, 1);
+    printf("\n(generated %ld splits in %.2f s)\n", max_splits, Now() - start);
+    Header("Polygon and splits built together (op = split)");
+    for (flat=0;flat<2;flat++) {
+        prev[flat].ops = 0;
+        prev_size = 0;
+        for (size=MIN_SPLITS;size;size=NextSize(size, max_splits)) {
+            bench.size = size;
+            bench.flat = flat;
+            prev[flat] = RunCase(flat ? "BuildFlatDcel" : "FlatApplySplits",
+                BuildCase, &bench, &prev[flat], prev_size);
+            prev_size = size;
+        }
+    }
+
+    // loading and output, against a fixed subdivision
+    FreeSplits(bench.splits);
+    int output_splits = max_splits < OUTPUT_SPLITS ? max_splits : OUTPUT_SPLITS;
+    bench.splits = MakeSplits(bench.polygon_path, output_splits, 0);
+    timing_t prev_load[2], prev_loop[3];
+    prev_load[0].ops = prev_load[1].ops = 0;
+    prev_loop[0].ops = prev_loop[1].ops = prev_loop[2].ops = 0;
+    char *loop_names[3] = {"ClassifyWts auto", "ClassifyWts faces", "ClassifyWts towers"};
+    int loop;
+    prev[0].ops = prev[1].ops = 0;
+    prev_size = 0;
+    char title[128];
+    snprintf(title, sizeof(title), "Loading and CreateOutput with %d faces (op = watchtower)",
+        1 + output_splits);
+    Header(title);
+    for (size=MIN_WTS;size;size=NextSize(size, max_wts)) {
+        WriteWts(bench.wts_path, size);
+        bench.size = size;
+        prev_load[0] = RunCase("ReadWtInfo", ReadCase, &bench, &prev_load[0], prev_size);
+        prev_load[1] = RunCase("MapWtFile", MapCase, &bench, &prev_load[1], prev_size);
+        for (loop=0;loop<3;loop++) {
+            bench.loop = loop;
+            prev_loop[loop] = RunCase(loop_names[loop], ClassifyCase, &bench,
+                &prev_loop[loop], prev_size);
+        }
+        for (flat=0;flat<2;flat++) {
+            bench.flat = flat;
+            prev[flat] = RunCase(flat ? "FlatCreateOutput" : "CreateOutput",
+                OutputCase, &bench, &prev[flat], prev_size);
+        }
+        prev_size = size;
+    }
+
+    // non-convex faces, against the largest watchtower file
+    FreeSplits(bench.splits);
+    bench.loop = ORDER_AUTO;
+    prev[0].ops = 0;
+    prev_size = 0;
+    snprintf(title, sizeof(title), "ClassifyWts against a polygon with growing notches, "
+        "%ld watchtowers (op = watchtower)", bench.size);
+    Header(title);
+    for (size=MIN_POLYGON;size;size=NextSize(size, MAX_POLYGON)) {
+        WriteNotched(bench.polygon_path, size);
+        bench.splits = MakeSplits(bench.polygon_path, 0, 0);
+        bench.size = size;
+        prev[0] = RunCase("ClassifyWts notched", ClassifyCase, &bench, &prev[0], prev_size);
+        FreeSplits(bench.splits);
+        prev_size = size;
+    }
+
+    // corners cut off one face, the worst case for relabelling after M-->B
+    Header("Corners cut off a polygon with 4 vertices per split (op = split)");
+    for (flat=0;flat<2;flat++) {
+        prev[flat].ops = 0;
+        prev_size = 0;
+        for (size=MIN_SPLITS;size;size=NextSize(size, MAX_CORNERS)) {
+            WritePolygon(bench.polygon_path, 4*size);
+            bench.splits = MakeCornerSplits(size);
+            bench.size = size;
+            bench.flat = flat;
+            prev[flat] = RunCase(flat ? "FlatApplySplits" : "FlatSplitFace", CornerCase,
+                &bench, &prev[flat], prev_size);
+            FreeSplits(bench.splits);
+            prev_size = size;
+        }
+    }
+
+    unlink(bench.polygon_path);
+    unlink(bench.wts_path);
+    return 0;
+}
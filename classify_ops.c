@@ -0,0 +1,408 @@
+// classify_ops.c
+// Finds which face each watchtower lies in
+
+// Handles the following:
+// - Grouping watchtowers by grid cell, sorted by x within each cell
+// - Skipping the watchtowers outside each candidate face's bounding box
+// - Checking each cell's watchtowers against the cell's faces of a frozen
+//       DCEL, face by face over tiles of watchtowers or watchtower by
+//       watchtower over the faces, optionally spread over several threads
+// - Collecting the (face, watchtower) matches and sorting them by face
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include "classify_ops.h"
+#include "hplane_ops.h"
+#include "stats_ops.h"
+
+// Threads take this many cells at a time
+#define CELL_CHUNK 16
+// Watchtowers checked against a face's edges together, small enough for
+// their coordinates and masks to stay in L1 while every edge passes over them
+#define TILE_WTS 512
+// With ORDER_AUTO, cells with at most this many watchtowers per candidate
+// face are checked watchtower by watchtower. Going face by face only pays
+// off once each face's edges are passed over long runs of watchtowers.
+#define TOWER_MAJOR_MAX 128
+
+// The cells shared out between threads, with the watchtowers
+// packed in cell order
+typedef struct {
+    face_grid_t *grid;
+    frozen_dcel_t *frozen;
+    // one of the ORDER_ loop orders
+    int loop;
+    int num_cells;
+    int *cell_start;
+    int *order;
+    double *xs;
+    double *ys;
+    int max_count;
+    // next cell to hand out, taken with an atomic add
+    int next_cell;
+} cell_work_t;
+
+// A watchtower's position and index, for sorting a cell's watchtowers by x
+typedef struct {
+    double x;
+    double y;
+    int w;
+} wt_pos_t;
+
+// One thread's share of the work and the matches it found
+typedef struct {
+    cell_work_t *work;
+    matches_t matches;
+} worker_t;
+
+static void *ClassifyCells(void *arg);
+
+// Orders watchtowers by x, then by index so the order is fully determined
+static int CompareX(const void *a, const void *b) {
+    const wt_pos_t *p = (const wt_pos_t*)a;
+    const wt_pos_t *q = (const wt_pos_t*)b;
+    if (p->x != q->x) {
+        return p->x < q->x ? -1 : 1;
+    }
+    return (p->w > q->w) - (p->w < q->w);
+}
+
+// Returns the first of n ascending xs which is at least x, or n if none is
+static int FirstAtLeast(double *xs, int n, double x) {
+    int lo = 0, hi = n;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (xs[mid] < x) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+// Returns the first of n ascending xs which is above x, or n if none is
+static int FirstAbove(double *xs, int n, double x) {
+    int lo = 0, hi = n;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (xs[mid] <= x) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+//==============================================================================
+// Finds every (face, watchtower) pair where the watchtower lies in the face.
+// Watchtowers are grouped by grid cell and packed into x and y arrays, sorted
+// by x within each cell, so the ones inside a face's bounding box form one
+// contiguous run. Only that run is checked against the face, a tile at a
+// time, one edge at a time with the batched half plane check.
+// Cells are independent, so with threads > 1 they are handed out in chunks
+// to a pool of threads. The matches found are the same however the cells
+// are shared out, only their order in matches differs.
+//==============================================================================
+void ClassifyWts(face_grid_t *grid, frozen_dcel_t *frozen,
+    wt_table_t *wts, int threads, matches_t *matches) {
+    ClassifyWtsInOrder(grid, frozen, wts, threads, ORDER_AUTO, matches);
+}
+
+// Same as ClassifyWts, checking every cell in the given ORDER_ loop order,
+// or choosing one per cell with ORDER_AUTO.
+// Both orders find the same matches.
+void ClassifyWtsInOrder(face_grid_t *grid, frozen_dcel_t *frozen,
+    wt_table_t *wts, int threads, int loop, matches_t *matches) {
+
+    int n = wts->n;
+    int w, c, k, t;
+    cell_work_t work;
+    work.grid = grid;
+    work.frozen = frozen;
+    work.loop = loop;
+    work.num_cells = grid->cols * grid->rows;
+    work.next_cell = 0;
+    int *cell_of;
+    if ( (cell_of = (int*)malloc(sizeof(int)*(n+1))) == NULL ||
+         (work.cell_start = (int*)calloc(work.num_cells+2, sizeof(int))) == NULL ||
+         (work.order = (int*)malloc(sizeof(int)*(n+1))) == NULL ||
+         (work.xs = (double*)malloc(sizeof(double)*(n+1))) == NULL ||
+         (work.ys = (double*)malloc(sizeof(double)*(n+1))) == NULL ) {
+        printf("malloc() error\n");
+        exit(EXIT_FAILURE);
+    }
+
+    // counting sort the watchtowers by cell, keeping watchtower order in each cell
+    // watchtowers outside the grid are left out
+    int *cell_start = work.cell_start;
+    for (w=0;w<n;w++) {
+        cell_of[w] = PointCell(grid, wts->x[w], wts->y[w]);
+        if (cell_of[w] >= 0) {
+            cell_start[cell_of[w]+2]++;
+        }
+    }
+    work.max_count = 0;
+    for (c=0;c<work.num_cells;c++) {
+        if (cell_start[c+2] > work.max_count) {
+            work.max_count = cell_start[c+2];
+        }
+        cell_start[c+2] += cell_start[c+1];
+    }
+    wt_pos_t *pos;
+    if ( (pos = (wt_pos_t*)malloc(sizeof(wt_pos_t)*(n+1))) == NULL ) {
+        printf("malloc() error\n");
+        exit(EXIT_FAILURE);
+    }
+    for (w=0;w<n;w++) {
+        if (cell_of[w] >= 0) {
+            k = cell_start[cell_of[w]+1]++;
+            pos[k] = (wt_pos_t){wts->x[w], wts->y[w], w};
+        }
+    }
+    // then sort each cell by x
+    for (c=0;c<work.num_cells;c++) {
+        int count = cell_start[c+1] - cell_start[c];
+        if (count > 1) {
+            qsort(pos + cell_start[c], count, sizeof(wt_pos_t), CompareX);
+        }
+    }
+    for (k=0;k<cell_start[work.num_cells];k++) {
+        work.order[k] = pos[k].w;
+        work.xs[k] = pos[k].x;
+        work.ys[k] = pos[k].y;
+    }
+    free(pos);
+    // cell c's watchtowers are now order[cell_start[c]] to order[cell_start[c+1]-1]
+
+    if (threads < 1) {
+        threads = 1;
+    }
+    worker_t *workers;
+    pthread_t *ids;
+    if ( (workers = (worker_t*)malloc(sizeof(worker_t)*threads)) == NULL ||
+         (ids = (pthread_t*)malloc(sizeof(pthread_t)*threads)) == NULL ) {
+        printf("malloc() error\n");
+        exit(EXIT_FAILURE);
+    }
+    for (t=0;t<threads;t++) {
+        workers[t].work = &work;
+        workers[t].matches = (matches_t){0, 0, NULL, NULL};
+    }
+
+    // the calling thread works too, as worker 0
+    for (t=1;t<threads;t++) {
+        if (pthread_create(&ids[t], NULL, ClassifyCells, &workers[t]) != 0) {
+            printf("pthread_create() error\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    ClassifyCells(&workers[0]);
+    for (t=1;t<threads;t++) {
+        pthread_join(ids[t], NULL);
+    }
+
+    // gather every thread's matches
+    for (t=0;t<threads;t++) {
+        for (k=0;k<workers[t].matches.num;k++) {
+            AddMatch(matches, workers[t].matches.face[k], workers[t].matches.wt[k]);
+        }
+        free(workers[t].matches.face);
+        free(workers[t].matches.wt);
+    }
+
+    free(workers);
+    free(ids);
+    free(cell_of);
+    free(work.cell_start);
+    free(work.order);
+    free(work.xs);
+    free(work.ys);
+
+}
+
+// Checks a cell's watchtowers one face at a time. The run of watchtowers
+// inside the face's box is cut into tiles, and every edge of the face passes
+// over a tile before the next tile is started.
+static void FaceMajor(cell_work_t *work, worker_t *worker, int start, int count,
+    int *cand, int num_cand, uint64_t *mask, uint64_t *edge_mask) {
+    double *xs = work->xs + start;
+    double *ys = work->ys + start;
+    int i, k, tile;
+    for (i=0;i<num_cand;i++) {
+        // only the run of watchtowers within the box's x range can be
+        // in the face, and of those only the ones within its y range
+        double *box = work->grid->boxes + 4*cand[i];
+        int lo = FirstAtLeast(xs, count, box[0]);
+        int hi = FirstAbove(xs, count, box[2]);
+        int inside = 0;
+        for (tile=lo;tile<hi;tile+=TILE_WTS) {
+            int len = hi - tile < TILE_WTS ? hi - tile : TILE_WTS;
+            int in_tile = 0;
+            for (k=0;k<MASK_WORDS(len);k++) {
+                mask[k] = 0;
+            }
+            for (k=0;k<len;k++) {
+                if (ys[tile+k] >= box[1] && ys[tile+k] <= box[3]) {
+                    mask[k >> 6] |= (uint64_t)1 << (k & 63);
+                    in_tile++;
+                }
+            }
+            inside += in_tile;
+            if (in_tile == 0) {
+                continue;
+            }
+            FrozenFaceMask(work->frozen, cand[i], xs+tile, ys+tile, len, mask, edge_mask);
+            for (k=0;k<len;k++) {
+                if ((mask[k >> 6] >> (k & 63)) & 1) {
+                    AddMatch(&worker->matches, cand[i], work->order[start+tile+k]);
+                }
+            }
+        }
+        STAT_ADD_SHARED(box_rejects, count - inside);
+    }
+}
+
+// Checks a cell's watchtowers one at a time, against each face whose box
+// holds it until one of them contains it. Faces do not overlap, so no
+// watchtower can be in a second face.
+static void TowerMajor(cell_work_t *work, worker_t *worker, int start, int count,
+    int *cand, int num_cand) {
+    int i, k;
+    int rejects = 0;
+    for (k=0;k<count;k++) {
+        double x = work->xs[start+k];
+        double y = work->ys[start+k];
+        for (i=0;i<num_cand;i++) {
+            double *box = work->grid->boxes + 4*cand[i];
+            if (x < box[0] || x > box[2] || y < box[1] || y > box[3]) {
+                rejects++;
+                continue;
+            }
+            if (FrozenInFace(work->frozen, cand[i], x, y)) {
+                AddMatch(&worker->matches, cand[i], work->order[start+k]);
+                break;
+            }
+        }
+    }
+    STAT_ADD_SHARED(box_rejects, rejects);
+}
+
+// Thread body: takes chunks of cells until none are left
+static void *ClassifyCells(void *arg) {
+    worker_t *worker = (worker_t*)arg;
+    cell_work_t *work = worker->work;
+    int c;
+
+    int tile = work->max_count < TILE_WTS ? work->max_count : TILE_WTS;
+    uint64_t *mask, *edge_mask;
+    if ( (mask = (uint64_t*)malloc(sizeof(uint64_t)*(MASK_WORDS(tile)+1))) == NULL ||
+         (edge_mask = (uint64_t*)malloc(sizeof(uint64_t)*(MASK_WORDS(tile)+1))) == NULL ) {
+        printf("malloc() error\n");
+        exit(EXIT_FAILURE);
+    }
+
+    int first;
+    while ((first = __atomic_fetch_add(&work->next_cell, CELL_CHUNK, __ATOMIC_RELAXED))
+        < work->num_cells) {
+        int last = first + CELL_CHUNK;
+        if (last > work->num_cells) {
+            last = work->num_cells;
+        }
+        for (c=first;c<last;c++) {
+            int start = work->cell_start[c];
+            int count = work->cell_start[c+1] - start;
+            if (count == 0) {
+                continue;
+            }
+            int num_cand;
+            int *cand = CellList(work->grid, c, &num_cand);
+            // watchtowers taken one at a time stop at their own face, and
+            // at the first edge they fail, which face by face they cannot
+            int loop = work->loop;
+            if (loop == ORDER_AUTO) {
+                loop = count <= TOWER_MAJOR_MAX * num_cand ?
+                    ORDER_TOWER_MAJOR : ORDER_FACE_MAJOR;
+            }
+            if (loop == ORDER_TOWER_MAJOR) {
+                TowerMajor(work, worker, start, count, cand, num_cand);
+            } else {
+                FaceMajor(work, worker, start, count, cand, num_cand, mask, edge_mask);
+            }
+        }
+    }
+
+    free(mask);
+    free(edge_mask);
+    return NULL;
+}
+
+// Sorts the matches by face, and by watchtower within each face, with
+// two counting sorts. n is the number of watchtowers.
+void SortMatches(matches_t *matches, int n, int num_face) {
+    int k, w, f;
+    int num = matches->num;
+    int *wt_start, *face_start, *by_wt, *face, *wt;
+    if ( (wt_start = (int*)calloc(n+1, sizeof(int))) == NULL ||
+         (face_start = (int*)calloc(num_face+1, sizeof(int))) == NULL ||
+         (by_wt = (int*)malloc(sizeof(int)*(num+1))) == NULL ||
+         (face = (int*)malloc(sizeof(int)*(num+1))) == NULL ||
+         (wt = (int*)malloc(sizeof(int)*(num+1))) == NULL ) {
+        printf("malloc() error\n");
+        exit(EXIT_FAILURE);
+    }
+
+    // by_wt lists the matches in watchtower order
+    for (k=0;k<num;k++) {
+        wt_start[matches->wt[k]+1]++;
+    }
+    for (w=0;w<n;w++) {
+        wt_start[w+1] += wt_start[w];
+    }
+    for (k=0;k<num;k++) {
+        by_wt[wt_start[matches->wt[k]]++] = k;
+    }
+
+    // then stably by face
+    for (k=0;k<num;k++) {
+        face_start[matches->face[k]+1]++;
+    }
+    for (f=0;f<num_face;f++) {
+        face_start[f+1] += face_start[f];
+    }
+    for (k=0;k<num;k++) {
+        int m = by_wt[k];
+        int to = face_start[matches->face[m]]++;
+        face[to] = matches->face[m];
+        wt[to] = matches->wt[m];
+    }
+
+    free(matches->face);
+    free(matches->wt);
+    matches->face = face;
+    matches->wt = wt;
+    matches->size = num+1;
+    free(wt_start);
+    free(face_start);
+    free(by_wt);
+}
+
+// Records that watchtower w lies in face f
+// A watchtower is normally in at most one face.
+void AddMatch(matches_t *matches, int f, int w) {
+    if (matches->num == matches->size) {
+        matches->size = matches->size ? matches->size*2 : 64;
+        if ( (matches->face = (int*)
+        realloc(matches->face, sizeof(int)*matches->size)) == NULL ||
+             (matches->wt = (int*)
+        realloc(matches->wt, sizeof(int)*matches->size)) == NULL ) {
+            printf("realloc() error\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    matches->face[matches->num] = f;
+    matches->wt[matches->num] = w;
+    matches->num++;
+}
@@ -0,0 +1,36 @@
+#ifndef CLASSIFY_OPS_H
+#define CLASSIFY_OPS_H
+
+#include <stdint.h>
+#include "wt_ops.h"
+#include "locate_ops.h"
+#include "frozen_ops.h"
+
+// (face, watchtower) pairs found while classifying watchtowers
+typedef struct {
+    int num;
+    int size;
+    int *face;
+    int *wt;
+} matches_t;
+
+// Orders for checking a grid cell's watchtowers against the cell's faces,
+// the first choosing one of the others per cell from its numbers of
+// watchtowers and faces
+#define ORDER_AUTO 0
+// each face in turn, against tiles of the watchtowers within its box
+#define ORDER_FACE_MAJOR 1
+// each watchtower in turn, against the faces until one contains it
+#define ORDER_TOWER_MAJOR 2
+
+void ClassifyWts(face_grid_t *grid, frozen_dcel_t *frozen,
+    wt_table_t *wts, int threads, matches_t *matches);
+
+void ClassifyWtsInOrder(face_grid_t *grid, frozen_dcel_t *frozen,
+    wt_table_t *wts, int threads, int loop, matches_t *matches);
+
+void SortMatches(matches_t *matches, int n, int num_face);
+
+void AddMatch(matches_t *matches, int f, int w);
+
+#endif
@@ -5,27 +5,43 @@
 // - Creating a DCEL and its components
 //       (vertices, faces, edges, half-edges i.e. hedges)
 // - Constructing a polygon
-// - Splitting a face by bisecting two edges
+// - Splitting a face by bisecting two edges, or by cutting them anywhere
+// - Renumbering the faces after a batch of splits which relabelled little
+//       more than the smaller side of each
+// - Keeping a bounding box for every face
 // - Checking if a point lies in a "clockwise" half-plane of two points
 // - Freeing a DCEL and its components
+//
+// The components themselves are carved out of the DCEL's arena rather than
+// malloc'd one by one, so they sit next to each other in memory and are
+// all freed at once.
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <math.h>
 #include <assert.h>
 #include "dcel_ops.h"
+#include "orient_ops.h"
+#include "stats_ops.h"
 
 #define V_START_SIZE 4
 #define F_START_SIZE 4
 #define E_START_SIZE 4
 #define H_START_SIZE 4
+// Size of the arena's first slab, later slabs double in size
+#define ARENA_START_SIZE 4096
 
 // Labelling the outside face simplifies things significantly
 // And it is also counted in the formula V + F = E + 2 for planar graphs.
 #define EXTERIOR_FACE -1
 
+// When splits keep an order, the larger side of a split is followed this
+// many times as far as the smaller side before being left unwalked
+#define SPLIT_SLACK 4
+
 //==============================================================================
-// The following 5 functions create a DCEL and its elements
+// The following 6 functions create a DCEL and its elements
 //==============================================================================
 
 // Returns pointer to a newly created DCEL
@@ -57,9 +73,47 @@ dcel_t *CreateDcel() {
         exit(EXIT_FAILURE);
     }
 
+    dcel->arena = CreateArena(ARENA_START_SIZE);
+    dcel->face_wts = NULL;
+
     return dcel;
 }
 
+// Grows the lists so that they can hold at least the given numbers of
+// vertices, faces and edges without being reallocated again
+void ReserveDcel(dcel_t *dcel, int num_vertex, int num_face, int num_edge) {
+    if (num_vertex > dcel->size_vertex_list) {
+        dcel->size_vertex_list = num_vertex;
+        if ( (dcel->vertex_list = (vertex_t**)
+        realloc(dcel->vertex_list, sizeof(vertex_t*)*num_vertex)) == NULL ) {
+            printf("realloc() error\n");
+            exit(EXIT_FAILURE);
+        }
+        STAT_ADD(heap_allocs, 1);
+        STAT_ADD(heap_bytes, sizeof(vertex_t*)*num_vertex);
+    }
+    if (num_face > dcel->size_face_list) {
+        dcel->size_face_list = num_face;
+        if ( (dcel->face_list = (face_t**)
+        realloc(dcel->face_list, sizeof(face_t*)*num_face)) == NULL ) {
+            printf("realloc() error\n");
+            exit(EXIT_FAILURE);
+        }
+        STAT_ADD(heap_allocs, 1);
+        STAT_ADD(heap_bytes, sizeof(face_t*)*num_face);
+    }
+    if (num_edge > dcel->size_edge_list) {
+        dcel->size_edge_list = num_edge;
+        if ( (dcel->edge_list = (edge_t**)
+        realloc(dcel->edge_list, sizeof(edge_t*)*num_edge)) == NULL ) {
+            printf("realloc() error\n");
+            exit(EXIT_FAILURE);
+        }
+        STAT_ADD(heap_allocs, 1);
+        STAT_ADD(heap_bytes, sizeof(edge_t*)*num_edge);
+    }
+}
+
 void AddVertex(dcel_t *dcel, double x, double y) {
     int *n = &dcel->num_vertex;
     int *size = &dcel->size_vertex_list;
@@ -71,12 +125,10 @@ void AddVertex(dcel_t *dcel, double x, double y) {
             printf("realloc() error\n");
             exit(EXIT_FAILURE);
         }
+        STAT_ADD(heap_allocs, 1);
+        STAT_ADD(heap_bytes, sizeof(vertex_t*)*(*size));
     }
-    vertex_t *v;
-    if ( (v = (vertex_t*)malloc(sizeof(vertex_t))) == NULL) {
-        printf("malloc() error\n");
-        exit(EXIT_FAILURE);
-    }
+    vertex_t *v = (vertex_t*)ArenaAlloc(dcel->arena, sizeof(vertex_t));
     v->index = *n;
     v->x = x;
     v->y = y;
@@ -95,14 +147,13 @@ void AddFace(dcel_t *dcel) {
             printf("realloc() error\n");
             exit(EXIT_FAILURE);
         }
+        STAT_ADD(heap_allocs, 1);
+        STAT_ADD(heap_bytes, sizeof(face_t*)*(*size));
     }
-    face_t *f;
-    if ( (f = (face_t*)malloc(sizeof(face_t))) == NULL) {
-        printf("malloc() error\n");
-        exit(EXIT_FAILURE);
-    }
+    face_t *f = (face_t*)ArenaAlloc(dcel->arena, sizeof(face_t));
     f->index = *n;
     f->hedge = NULL;
+    f->box[0] = f->box[1] = f->box[2] = f->box[3] = 0;
     dcel->face_list[*n] = f;
     *n+=1;
 }
@@ -121,26 +172,20 @@ void AddEdge(dcel_t *dcel, int v_s, int v_e, int f1, int f2) {
             printf("realloc() error\n");
             exit(EXIT_FAILURE);
         }
+        STAT_ADD(heap_allocs, 1);
+        STAT_ADD(heap_bytes, sizeof(edge_t*)*(*size));
     }
-    edge_t *e;
-    if ( (e = (edge_t*)malloc(sizeof(edge_t))) == NULL) {
-        printf("malloc() error\n");
-        exit(EXIT_FAILURE);
-    }
+    edge_t *e = (edge_t*)ArenaAlloc(dcel->arena, sizeof(edge_t));
     e->index = *n;
-    e->hedge = AddHedge(v_s, v_e, f1, *n);
-    e->hedge->twin = AddHedge(v_e, v_s, f2, *n);
+    e->hedge = AddHedge(dcel, v_s, v_e, f1, *n);
+    e->hedge->twin = AddHedge(dcel, v_e, v_s, f2, *n);
     e->hedge->twin->twin = e->hedge;
     dcel->edge_list[*n] = e;
     *n+=1;
 }
 
-hedge_t *AddHedge(int v_s, int v_e, int f, int e) {
-    hedge_t *hedge;
-    if ( (hedge = (hedge_t*)malloc(sizeof(hedge_t))) == NULL ) {
-        printf("malloc() error\n");
-        exit(EXIT_FAILURE);
-    }
+hedge_t *AddHedge(dcel_t *dcel, int v_s, int v_e, int f, int e) {
+    hedge_t *hedge = (hedge_t*)ArenaAlloc(dcel->arena, sizeof(hedge_t));
     hedge->v_start = v_s;
     hedge->v_end = v_e;
     hedge->face = f;
@@ -179,65 +224,101 @@ void FirstPolygon(dcel_t *dcel, FILE *file) {
         dcel->edge_list[i]->hedge->twin->next = dcel->edge_list[(n+i-1)%n]->hedge->twin;
         dcel->edge_list[i]->hedge->twin->prev = dcel->edge_list[(i+1)%n]->hedge->twin;
     }
+    FitFaceBox(dcel, 0);
 }
 
-//==============================================================================
-// Bisects two edges, which adds 2 vertices + the edge which does the bisection
-// + a face. Also makes appropriate changes to the half edges.
-//==============================================================================
-void SplitFace(dcel_t *dcel, int e1, int e2) {
-    // First identify the face where the split is occuring.
-    // Then make the edge point to the half-edge that is part of the face, 
-    // rather than point to the half-edge that is not part of the face.
-    // This ensures that the new edges are created in the correct position and order.
+// Sets the bounding box of face f to exactly cover its vertices
+void FitFaceBox(dcel_t *dcel, int f) {
+    double *box = dcel->face_list[f]->box;
+    hedge_t *start = dcel->face_list[f]->hedge;
+    hedge_t *hedge = start;
+    box[0] = box[2] = dcel->vertex_list[start->v_start]->x;
+    box[1] = box[3] = dcel->vertex_list[start->v_start]->y;
+    do {
+        vertex_t *v = dcel->vertex_list[hedge->v_start];
+        if (v->x < box[0]) box[0] = v->x;
+        if (v->y < box[1]) box[1] = v->y;
+        if (v->x > box[2]) box[2] = v->x;
+        if (v->y > box[3]) box[3] = v->y;
+        hedge = hedge->next;
+    } while (hedge != start);
+}
 
-    hedge_t *h1 = dcel->edge_list[e1]->hedge;
-    hedge_t *h2 = dcel->edge_list[e2]->hedge;
+// Widens a bounding box to cover (x, y)
+static void WidenBox(double *box, double x, double y) {
+    if (x < box[0]) box[0] = x;
+    if (y < box[1]) box[1] = y;
+    if (x > box[2]) box[2] = x;
+    if (y > box[3]) box[3] = y;
+}
 
-    // Temporary variables to help compute
-    // the midpoint M of AB and midpoint N of CD
-    // (AB and CD could be oriented incorrectly, but that does not matter)
-    int e1A = h1->v_start;
-    int e1B = h1->v_end;
-    double Ax = dcel->vertex_list[e1A]->x;
-    double Ay = dcel->vertex_list[e1A]->y;
-    double Bx = dcel->vertex_list[e1B]->x;
-    double By = dcel->vertex_list[e1B]->y;
-    int e2A = h2->v_start;
-    int e2B = h2->v_end;
-    double Cx = dcel->vertex_list[e2A]->x;
-    double Cy = dcel->vertex_list[e2A]->y;
-    double Dx = dcel->vertex_list[e2B]->x;
-    double Dy = dcel->vertex_list[e2B]->y;
-
-    double Mx = (Ax + Bx) / 2;
-    double My = (Ay + By) / 2;
-    double Nx = (Cx + Dx) / 2;
-    double Ny = (Cy + Dy) / 2;
-    // create a temporary test point P for testing face
-    double Px = (Mx + Nx) / 2;
-    double Py = (My + Ny) / 2;
-    if (!HalfPlane(dcel, h1->v_start, h1->v_end, Px, Py)) {
-        dcel->edge_list[e1]->hedge = dcel->edge_list[e1]->hedge->twin;
-    }
-    if (!HalfPlane(dcel, h2->v_start, h2->v_end, Px, Py)) {
-        dcel->edge_list[e2]->hedge = dcel->edge_list[e2]->hedge->twin;
+// Empties the bounding box of face f, for RenumberFaces to refit
+static void EmptyFaceBox(dcel_t *dcel, int f) {
+    double *box = dcel->face_list[f]->box;
+    box[0] = box[1] = INFINITY;
+    box[2] = box[3] = -INFINITY;
+}
+
+// Moves the watchtowers now in face_new out of face_old, which keeps M-->N.
+// The split has already walked face_new's side, so handing over its ring
+// when face_old may not be convex costs no more than the split itself.
+static void SplitWts(dcel_t *dcel, int face_old, int face_new,
+    double Mx, double My, double Nx, double Ny) {
+    double *ring = NULL;
+    int n = 0;
+    if (FaceWtsNeedRing(dcel->face_wts, face_old)) {
+        hedge_t *start = dcel->face_list[face_new]->hedge;
+        hedge_t *h = start;
+        do {
+            n++;
+            h = h->next;
+        } while (h != start);
+        if ( (ring = (double*)malloc(sizeof(double)*2*n)) == NULL ) {
+            printf("malloc() error\n");
+            exit(EXIT_FAILURE);
+        }
+        n = 0;
+        do {
+            ring[2*n] = dcel->vertex_list[h->v_start]->x;
+            ring[2*n+1] = dcel->vertex_list[h->v_start]->y;
+            n++;
+            h = h->next;
+        } while (h != start);
     }
+    SplitFaceWts(dcel->face_wts, face_old, face_new, Mx, My, Nx, Ny, ring, n);
+    free(ring);
+}
 
-    // Now both edges point to half-edges which are in the face we are splitting
+//==============================================================================
+// Bisects two edges, which adds 2 vertices + the edge which does the bisection
+// + a face. Also makes appropriate changes to the half edges.
+// AM and ND are the half-edges of the two edges lying in the face being split,
+// and M and N are the new vertices, which lie on A-->B and C-->D.
+// If order is NULL the new face is always the side after M-->B, as SplitFace
+// has always numbered it, and both faces' bounding boxes are refitted.
+// Otherwise the split costs no more than a few times its smaller side. When
+// the larger side turns out to be more than SPLIT_SLACK times longer, it is
+// left unwalked: it keeps face_old's half-edges and its box is emptied, and
+// if it is the side after M-->B the smaller side becomes the new face instead.
+// order is kept so that order[f] is the number face f would have had if the
+// side after M-->B had always been relabelled, for RenumberFaces to put
+// right along with the emptied boxes.
+// Returns the index of the new face.
+//==============================================================================
+static int SplitHedges(dcel_t *dcel, hedge_t *AM, hedge_t *ND,
+    double Mx, double My, double Nx, double Ny, int *order) {
 
     // Now let first edge = A-->B, second edge = C-->D (clockwise order)
+
     // Add 2 vertices
-    // Let this be M, midpoint of A-->B
+    // Let this be M, on A-->B
     int m_i = dcel->num_vertex;
     AddVertex(dcel, Mx, My);
-    // Let this be N, midpoint of C-->D
+    // Let this be N, on C-->D
     int n_i = dcel->num_vertex;
     AddVertex(dcel, Nx, Ny);
 
-    // Give names to edges
-    hedge_t *AM = dcel->edge_list[e1]->hedge;
-    hedge_t *ND = dcel->edge_list[e2]->hedge;
+    STAT_ADD(split_faces, 1);
 
     // face indices
     int face_old = AM->face;
@@ -257,7 +338,7 @@ void SplitFace(dcel_t *dcel, int e1, int e2) {
 
     // Pre-processing for 2nd edge
     // change A-->B into A-->M
-    e1B = AM->v_end;
+    int e1B = AM->v_end;
     hedge_t *old_next_hedge = AM->next;
     hedge_t *old_prev_hedge_twin = AM->twin->prev;
     AM->v_end = m_i;
@@ -280,9 +361,9 @@ void SplitFace(dcel_t *dcel, int e1, int e2) {
 
     // Pre-processing for 3rd edge
     // change C-->D into N-->D
-    e2A = ND->v_start;
-    hedge_t *old_prev_hedge = dcel->edge_list[e2]->hedge->prev;
-    hedge_t *old_next_hedge_twin = dcel->edge_list[e2]->hedge->twin->next;
+    int e2A = ND->v_start;
+    hedge_t *old_prev_hedge = ND->prev;
+    hedge_t *old_next_hedge_twin = ND->twin->next;
     ND->v_start = n_i;
     ND->twin->v_end = n_i;
     ND->prev = MN;
@@ -301,28 +382,229 @@ void SplitFace(dcel_t *dcel, int e1, int e2) {
     CN->twin->prev = ND->twin;
     ND->twin->next = CN->twin;
 
-    // update faces
+    // Walk both sides in lockstep, so finding the smaller side costs
+    // no more than walking it, then follow the larger side a bounded way on.
+    // Each side's box is widened as it is walked, so neither side needs
+    // walking again to fit its box.
     hedge_t *h = MB;
-    while (h != CN) {
+    hedge_t *k = ND;
+    int unwalked = 0;
+    double box_h[4] = {Nx, Ny, Nx, Ny};
+    double box_k[4] = {Mx, My, Mx, My};
+    if (order) {
+        int budget = SPLIT_SLACK;
+        order[face_new] = face_new;
+        WidenBox(box_h, dcel->vertex_list[CN->v_start]->x, dcel->vertex_list[CN->v_start]->y);
+        WidenBox(box_k, dcel->vertex_list[AM->v_start]->x, dcel->vertex_list[AM->v_start]->y);
+        while (h != CN && k != AM) {
+            WidenBox(box_h, dcel->vertex_list[h->v_start]->x, dcel->vertex_list[h->v_start]->y);
+            WidenBox(box_k, dcel->vertex_list[k->v_start]->x, dcel->vertex_list[k->v_start]->y);
+            h = h->next;
+            k = k->next;
+            budget += SPLIT_SLACK;
+            STAT_ADD(split_hedges, 2);
+        }
+        for (;h != CN && budget > 0;budget--) {
+            WidenBox(box_h, dcel->vertex_list[h->v_start]->x, dcel->vertex_list[h->v_start]->y);
+            h = h->next;
+            STAT_ADD(split_hedges, 1);
+        }
+        for (;k != AM && budget > 0;budget--) {
+            WidenBox(box_k, dcel->vertex_list[k->v_start]->x, dcel->vertex_list[k->v_start]->y);
+            k = k->next;
+            STAT_ADD(split_hedges, 1);
+        }
+        unwalked = h != CN || k != AM;
+    }
+
+    if (unwalked && h != CN) {
+        // the side after M-->B is too long to relabel, so the side
+        // after N-->D becomes the new face
+        MN->face = face_new;
+        for (k=ND;k!=MN;k=k->next) {
+            k->face = face_new;
+            STAT_ADD(split_hedges, 1);
+        }
+        MN->twin->face = MB->face = CN->face = face_old;
+        dcel->face_list[face_old]->hedge = MN->twin;
+        dcel->face_list[face_new]->hedge = MN;
+        // the two sides swap numbers when the faces are renumbered
+        order[face_new] = order[face_old];
+        order[face_old] = face_new;
+        memcpy(dcel->face_list[face_new]->box, box_k, sizeof(box_k));
+        EmptyFaceBox(dcel, face_old);
+        if (dcel->face_wts) {
+            SplitWts(dcel, face_old, face_new, Nx, Ny, Mx, My);
+        }
+        return face_new;
+    }
+
+    // update faces
+    for (h=MB;h!=CN;h=h->next) {
         h->face = face_new;
-        h = h->next;
+        STAT_ADD(split_hedges, 1);
+    }
+    if (order == NULL) {
+        FitFaceBox(dcel, face_new);
+        FitFaceBox(dcel, face_old);
+    } else {
+        memcpy(dcel->face_list[face_new]->box, box_h, sizeof(box_h));
+        if (unwalked) {
+            EmptyFaceBox(dcel, face_old);
+        } else {
+            memcpy(dcel->face_list[face_old]->box, box_k, sizeof(box_k));
+        }
+    }
+
+    // move the watchtowers now on the new face's side of M-->N
+    if (dcel->face_wts) {
+        SplitWts(dcel, face_old, face_new, Mx, My, Nx, Ny);
+    }
+    return face_new;
+}
+
+// Returns the coordinate a fraction t of the way from a to b, which for a
+// half is the midpoint, worked out as SplitFace works it out
+static double PointAlong(double a, double b, double t) {
+    return t == 0.5 ? (a + b) / 2 : a + t * (b - a);
+}
+
+// Picks the half-edges of edges e1 and e2 which have P = (M + N) / 2 on
+// their side, and splits the face between them at M and N if both are in it.
+// Returns the index of the new face, or -1 without changing anything if they
+// are not both in the one face.
+static int SplitThrough(dcel_t *dcel, hedge_t *h1, hedge_t *h2,
+    double Mx, double My, double Nx, double Ny, int *order) {
+    double Px = (Mx + Nx) / 2;
+    double Py = (My + Ny) / 2;
+    if (!HalfPlane(dcel, h1->v_start, h1->v_end, Px, Py)) {
+        h1 = h1->twin;
+    }
+    if (!HalfPlane(dcel, h2->v_start, h2->v_end, Px, Py)) {
+        h2 = h2->twin;
+    }
+    if (h1->face != h2->face || h1->face == EXTERIOR_FACE) {
+        return -1;
+    }
+    return SplitHedges(dcel, h1, h2, Mx, My, Nx, Ny, order);
+}
+
+//==============================================================================
+// Splits the face between edges e1 and e2, working out which face that is
+// from a test point P between the two edge midpoints.
+// Returns the index of the new face, or -1 without changing anything if the
+// edges do not both bound the face holding P.
+// If order is given, the split costs little more than its smaller side, and
+// the faces must be put in order by RenumberFaces once the splits are done.
+//==============================================================================
+int SplitFace(dcel_t *dcel, int e1, int e2, int *order) {
+    // First identify the face where the split is occuring, by picking
+    // the half-edge of each edge which has P on its side.
+    // The edges themselves are left pointing at the same half-edge.
+    // (AB and CD could be oriented incorrectly, but that does not matter)
+    hedge_t *h1 = dcel->edge_list[e1]->hedge;
+    hedge_t *h2 = dcel->edge_list[e2]->hedge;
+    vertex_t *A = dcel->vertex_list[h1->v_start];
+    vertex_t *B = dcel->vertex_list[h1->v_end];
+    vertex_t *C = dcel->vertex_list[h2->v_start];
+    vertex_t *D = dcel->vertex_list[h2->v_end];
+
+    // M is the midpoint of A-->B and N is the midpoint of C-->D
+    return SplitThrough(dcel, h1, h2, (A->x + B->x) / 2, (A->y + B->y) / 2,
+        (C->x + D->x) / 2, (C->y + D->y) / 2, order);
+}
+
+//==============================================================================
+// Splits the face between edges e1 and e2 along the line through the point
+// a fraction t1 of the way along e1 and the point a fraction t2 of the way
+// along e2, each measured from the start of the edge's own half-edge.
+// The face is worked out as in SplitFace, from a test point P halfway
+// between the two points. One such split can stand in for the many midpoint
+// splits it would otherwise take to cut a face at the same place. A fraction
+// of exactly a half gives the midpoint just as SplitFace works it out.
+// Returns the index of the new face, or -1 if the split is invalid, which
+// includes the edges not both bounding the face holding P.
+// order is used as in SplitFace.
+//==============================================================================
+int SplitFaceAt(dcel_t *dcel, int e1, double t1, int e2, double t2, int *order) {
+    if (e1 == e2 || e1 < 0 || e2 < 0 || e1 >= dcel->num_edge || e2 >= dcel->num_edge ||
+        !(t1 > 0 && t1 < 1) || !(t2 > 0 && t2 < 1)) {
+        return -1;
+    }
+    hedge_t *h1 = dcel->edge_list[e1]->hedge;
+    hedge_t *h2 = dcel->edge_list[e2]->hedge;
+    vertex_t *A = dcel->vertex_list[h1->v_start];
+    vertex_t *B = dcel->vertex_list[h1->v_end];
+    vertex_t *C = dcel->vertex_list[h2->v_start];
+    vertex_t *D = dcel->vertex_list[h2->v_end];
+    return SplitThrough(dcel, h1, h2, PointAlong(A->x, B->x, t1), PointAlong(A->y, B->y, t1),
+        PointAlong(C->x, D->x, t2), PointAlong(C->y, D->y, t2), order);
+}
+
+//==============================================================================
+// Gives every face f the number order[f], as kept by a batch of splits which
+// relabelled little more than the smaller side of each, so the faces end up
+// numbered as if every split had relabelled the side after M-->B, and refits
+// every box the splits emptied. Half-edges are only relabelled if some face moved, in
+// one pass down the edge list, so a batch in which every split was made as
+// SplitFace with no order would have made it costs one pass over the faces.
+// The faces are moved in place, which uses order up, leaving it as f -> f.
+//==============================================================================
+void RenumberFaces(dcel_t *dcel, int *order) {
+    int e, f, moved = 0;
+    for (f=0;f<dcel->num_face;f++) {
+        moved |= order[f] != f;
+    }
+    if (moved) {
+        for (e=0;e<dcel->num_edge;e++) {
+            hedge_t *h = dcel->edge_list[e]->hedge;
+            if (h->face != EXTERIOR_FACE) {
+                h->face = order[h->face];
+            }
+            if (h->twin->face != EXTERIOR_FACE) {
+                h->twin->face = order[h->twin->face];
+            }
+        }
+        if (dcel->face_wts) {
+            RenumberFaceWts(dcel->face_wts, order);
+        }
+        // swap face f into place until the face swapped back belongs at f
+        for (f=0;f<dcel->num_face;f++) {
+            while (order[f] != f) {
+                int g = order[f];
+                face_t *face = dcel->face_list[g];
+                dcel->face_list[g] = dcel->face_list[f];
+                dcel->face_list[g]->index = g;
+                dcel->face_list[f] = face;
+                dcel->face_list[f]->index = f;
+                order[f] = order[g];
+                order[g] = g;
+            }
+        }
+    }
+    for (f=0;f<dcel->num_face;f++) {
+        if (dcel->face_list[f]->box[0] > dcel->face_list[f]->box[2]) {
+            FitFaceBox(dcel, f);
+        }
     }
 }
 
 // Returns 1 if P is in the same half plane as the half edge A-->B, otherwise returns 0
 // By right hand rule, this is true if (A-->P) X (A-->B) has positive orientation
 // i.e. the quantity x1y2 - x2y1 is positive
+// The sign is computed exactly, so points very close to AB, such as the
+// midpoints made by deep split sequences, still land on the correct side.
 int HalfPlane(dcel_t *dcel, int v1, int v2, double Px, double Py) {
     vertex_t *A = dcel->vertex_list[v1];
     vertex_t *B = dcel->vertex_list[v2];
-    return ((Px - A->x)*(B->y - A->y) > (B->x - A->x)*(Py - A->y));
+    STAT_ADD_SHARED(half_plane, 1);
+    return Orient2d(A->x, A->y, B->x, B->y, Px, Py) > 0;
 
     // Remarks:
-    // For a more general usage of this function, I would instead
-    // return 1 if P is in the "clockwise" half plane of AB
-    // return 0 if P lies on AB
-    // return -1 if P is in the "anticlockwise" half plane of AB
-    // This will suffice for now
+    // For a more general usage, Orient2d returns
+    // 1 if P is in the "clockwise" half plane of AB
+    // 0 if P lies on AB
+    // -1 if P is in the "anticlockwise" half plane of AB
 }
 
 // Prints out DCEL for debugging
@@ -352,25 +634,11 @@ void PrintDcel(dcel_t *dcel) {
 }
 
 // Free the DCEL components and the DCEL
+// The components all live in the arena, so only the lists need freeing
 void FreeDcel(dcel_t *dcel) {
-    int i;
-
-    for (i=0;i<dcel->num_vertex;i++) {
-        free(dcel->vertex_list[i]);
-    }
     free(dcel->vertex_list);
-
-    for (i=0;i<dcel->num_face;i++) {
-        free(dcel->face_list[i]);
-    }
     free(dcel->face_list);
-
-    for (i=0;i<dcel->num_edge;i++) {
-        free(dcel->edge_list[i]->hedge->twin);
-        free(dcel->edge_list[i]->hedge);
-        free(dcel->edge_list[i]);
-    }
     free(dcel->edge_list);
-
+    FreeArena(dcel->arena);
     free(dcel);
 }
\ No newline at end of file
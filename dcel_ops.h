@@ -1,3 +1,9 @@
+#ifndef DCEL_OPS_H
+#define DCEL_OPS_H
+
+#include "arena_ops.h"
+#include "pop_ops.h"
+
 // hedge meaning half-edge
 typedef struct hedge hedge_t;
 
@@ -20,6 +26,9 @@ typedef struct {
 typedef struct {
     int index;
     hedge_t *hedge;
+    // bounding box: min x, min y, max x, max y, always containing the face
+    // except during a batch of splits, which may leave it empty
+    double box[4];
 } face_t;
 
 typedef struct {
@@ -37,24 +46,38 @@ typedef struct {
     int num_edge;
     int size_edge_list;
     edge_t **edge_list;
+    // vertices, faces, edges and half-edges are all allocated from here
+    arena_t *arena;
+    // if set, kept up to date by SplitFace, but not owned by the DCEL
+    face_wts_t *face_wts;
 } dcel_t;
 
 dcel_t *CreateDcel();
 
+void ReserveDcel(dcel_t *dcel, int num_vertex, int num_face, int num_edge);
+
 void AddVertex(dcel_t *dcel, double x, double y);
 
 void AddFace(dcel_t *dcel);
 
 void AddEdge(dcel_t *dcel, int v_s, int v_e, int f1, int f2);
 
-hedge_t *AddHedge(int v_s, int v_e, int f, int e);
+hedge_t *AddHedge(dcel_t *dcel, int v_s, int v_e, int f, int e);
 
 void FirstPolygon(dcel_t *dcel, FILE *file);
 
-void SplitFace(dcel_t *dcel, int e1, int e2);
+void FitFaceBox(dcel_t *dcel, int f);
+
+int SplitFace(dcel_t *dcel, int e1, int e2, int *order);
+
+int SplitFaceAt(dcel_t *dcel, int e1, double t1, int e2, double t2, int *order);
+
+void RenumberFaces(dcel_t *dcel, int *order);
 
 int HalfPlane(dcel_t *dcel, int v1, int v2, double P_x, double P_y);
 
 void PrintDcel(dcel_t *dcel);
 
-void FreeDcel(dcel_t *dcel);
\ No newline at end of file
+void FreeDcel(dcel_t *dcel);
+
+#endif
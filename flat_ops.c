@@ -0,0 +1,614 @@
+// flat_ops.c
+// DCEL Operations on the flat (structure of arrays) layout
+
+// Mirrors dcel_ops.c, handling the following:
+// - Creating a flat DCEL and its elements
+// - Creating a flat DCEL of a known size in a single allocation
+// - Taking over the arrays of a DCEL mapped from a snapshot, or carved out of
+//       a single allocation, when it grows
+// - Constructing a polygon
+// - Splitting a face by bisecting two edges, or by cutting them anywhere
+// - Renumbering the faces after a batch of splits which relabelled little
+//       more than the smaller side of each
+// - Keeping a bounding box for every face
+// - Checking if a point lies in a "clockwise" half-plane of two points
+// - Freeing a flat DCEL
+// Every element is an index into the arrays, so nothing is allocated
+// per element and a face walk only touches a few dense int arrays.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <sys/mman.h>
+#include "flat_ops.h"
+#include "orient_ops.h"
+#include "stats_ops.h"
+
+#define V_START_SIZE 4
+#define F_START_SIZE 4
+#define H_START_SIZE 8
+
+#define EXTERIOR_FACE -1
+
+// Same as in dcel_ops.c
+#define SPLIT_SLACK 4
+
+// Grows an array to hold size elements of elem bytes each
+static void *Grow(void *array, size_t elem, int size) {
+    if ( (array = realloc(array, elem*size)) == NULL ) {
+        printf("realloc() error\n");
+        exit(EXIT_FAILURE);
+    }
+    STAT_ADD(heap_allocs, 1);
+    STAT_ADD(heap_bytes, elem*size);
+    return array;
+}
+
+//==============================================================================
+// The following 6 functions create a flat DCEL and its elements
+//==============================================================================
+
+// Returns pointer to a newly created flat DCEL
+flat_dcel_t *CreateFlatDcel() {
+    flat_dcel_t *dcel;
+    if ( (dcel = (flat_dcel_t*)malloc(sizeof(flat_dcel_t))) == NULL ) {
+        printf("malloc() error\n");
+        exit(EXIT_FAILURE);
+    }
+
+    dcel->num_vertex = 0;
+    dcel->size_vertex = V_START_SIZE;
+    dcel->xs = (double*)Grow(NULL, sizeof(double), V_START_SIZE);
+    dcel->ys = (double*)Grow(NULL, sizeof(double), V_START_SIZE);
+
+    dcel->num_face = 0;
+    dcel->size_face = F_START_SIZE;
+    dcel->face_hedge = (int32_t*)Grow(NULL, sizeof(int32_t), F_START_SIZE);
+    dcel->face_box = (double*)Grow(NULL, 4*sizeof(double), F_START_SIZE);
+
+    dcel->num_hedge = 0;
+    dcel->size_hedge = H_START_SIZE;
+    dcel->h_start = (int32_t*)Grow(NULL, sizeof(int32_t), H_START_SIZE);
+    dcel->h_face = (int32_t*)Grow(NULL, sizeof(int32_t), H_START_SIZE);
+    dcel->h_next = (int32_t*)Grow(NULL, sizeof(int32_t), H_START_SIZE);
+    dcel->h_prev = (int32_t*)Grow(NULL, sizeof(int32_t), H_START_SIZE);
+
+    dcel->face_wts = NULL;
+    dcel->map = NULL;
+    dcel->map_len = 0;
+    dcel->block = NULL;
+
+    return dcel;
+}
+
+// Returns pointer to a flat DCEL with room for exactly the given numbers of
+// vertices, faces and half-edges, with every array carved out of one block
+// in the same order as a snapshot file
+flat_dcel_t *CreateSizedFlatDcel(int num_vertex, int num_face, int num_hedge) {
+    flat_dcel_t *dcel;
+    if ( (dcel = (flat_dcel_t*)malloc(sizeof(flat_dcel_t))) == NULL ) {
+        printf("malloc() error\n");
+        exit(EXIT_FAILURE);
+    }
+    // half-edges are added in twos, so keep the size even
+    num_hedge += num_hedge % 2;
+    int nv = dcel->size_vertex = num_vertex;
+    int nf = dcel->size_face = num_face;
+    int nh = dcel->size_hedge = num_hedge;
+    dcel->num_vertex = dcel->num_face = dcel->num_hedge = 0;
+
+    // the doubles come first, so every array stays aligned
+    size_t len = sizeof(double)*(2*(size_t)nv + 4*(size_t)nf) +
+        sizeof(int32_t)*((size_t)nf + 4*(size_t)nh);
+    char *p = (char*)Grow(NULL, 1, len > 0 ? len : 1);
+    dcel->block = p;
+    dcel->xs = (double*)p;
+    p += sizeof(double)*nv;
+    dcel->ys = (double*)p;
+    p += sizeof(double)*nv;
+    dcel->face_box = (double*)p;
+    p += 4*sizeof(double)*nf;
+    dcel->face_hedge = (int32_t*)p;
+    p += sizeof(int32_t)*nf;
+    dcel->h_start = (int32_t*)p;
+    p += sizeof(int32_t)*nh;
+    dcel->h_face = (int32_t*)p;
+    p += sizeof(int32_t)*nh;
+    dcel->h_next = (int32_t*)p;
+    p += sizeof(int32_t)*nh;
+    dcel->h_prev = (int32_t*)p;
+
+    dcel->face_wts = NULL;
+    dcel->map = NULL;
+    dcel->map_len = 0;
+    return dcel;
+}
+
+// Copies an array out of a mapping into allocated memory
+static void *Unshare(void *array, size_t elem, int num, int size) {
+    void *copy = Grow(NULL, elem, size > 0 ? size : 1);
+    memcpy(copy, array, elem*num);
+    return copy;
+}
+
+// Moves the arrays of a DCEL loaded from a snapshot, or carved out of a single
+// block, into separately allocated memory and releases the snapshot or block,
+// so the arrays can grow like any others.
+// Does nothing for a DCEL whose arrays are already allocated one by one.
+void FlatDetachMap(flat_dcel_t *dcel) {
+    if (dcel->map == NULL && dcel->block == NULL) {
+        return;
+    }
+    int nv = dcel->num_vertex, nf = dcel->num_face, nh = dcel->num_hedge;
+    // the arrays may be exactly full, and may even be empty
+    if (dcel->size_vertex < V_START_SIZE) dcel->size_vertex = V_START_SIZE;
+    if (dcel->size_face < F_START_SIZE) dcel->size_face = F_START_SIZE;
+    if (dcel->size_hedge < H_START_SIZE) dcel->size_hedge = H_START_SIZE;
+    dcel->xs = (double*)Unshare(dcel->xs, sizeof(double), nv, dcel->size_vertex);
+    dcel->ys = (double*)Unshare(dcel->ys, sizeof(double), nv, dcel->size_vertex);
+    dcel->face_hedge = (int32_t*)Unshare(dcel->face_hedge, sizeof(int32_t), nf, dcel->size_face);
+    dcel->face_box = (double*)Unshare(dcel->face_box, 4*sizeof(double), nf, dcel->size_face);
+    dcel->h_start = (int32_t*)Unshare(dcel->h_start, sizeof(int32_t), nh, dcel->size_hedge);
+    dcel->h_face = (int32_t*)Unshare(dcel->h_face, sizeof(int32_t), nh, dcel->size_hedge);
+    dcel->h_next = (int32_t*)Unshare(dcel->h_next, sizeof(int32_t), nh, dcel->size_hedge);
+    dcel->h_prev = (int32_t*)Unshare(dcel->h_prev, sizeof(int32_t), nh, dcel->size_hedge);
+    if (dcel->map) {
+        munmap(dcel->map, dcel->map_len);
+    }
+    free(dcel->block);
+    dcel->map = NULL;
+    dcel->map_len = 0;
+    dcel->block = NULL;
+}
+
+// Grows the arrays so that they can hold at least the given numbers of
+// vertices, faces and half-edges without being reallocated again
+void FlatReserveDcel(flat_dcel_t *dcel, int num_vertex, int num_face, int num_hedge) {
+    if (num_vertex > dcel->size_vertex || num_face > dcel->size_face ||
+        num_hedge > dcel->size_hedge) {
+        FlatDetachMap(dcel);
+    }
+    if (num_vertex > dcel->size_vertex) {
+        dcel->size_vertex = num_vertex;
+        dcel->xs = (double*)Grow(dcel->xs, sizeof(double), num_vertex);
+        dcel->ys = (double*)Grow(dcel->ys, sizeof(double), num_vertex);
+    }
+    if (num_face > dcel->size_face) {
+        dcel->size_face = num_face;
+        dcel->face_hedge = (int32_t*)Grow(dcel->face_hedge, sizeof(int32_t), num_face);
+        dcel->face_box = (double*)Grow(dcel->face_box, 4*sizeof(double), num_face);
+    }
+    // half-edges are added in twos, so keep the size even
+    num_hedge += num_hedge % 2;
+    if (num_hedge > dcel->size_hedge) {
+        dcel->size_hedge = num_hedge;
+        dcel->h_start = (int32_t*)Grow(dcel->h_start, sizeof(int32_t), num_hedge);
+        dcel->h_face = (int32_t*)Grow(dcel->h_face, sizeof(int32_t), num_hedge);
+        dcel->h_next = (int32_t*)Grow(dcel->h_next, sizeof(int32_t), num_hedge);
+        dcel->h_prev = (int32_t*)Grow(dcel->h_prev, sizeof(int32_t), num_hedge);
+    }
+}
+
+// Returns the index of the new vertex
+int FlatAddVertex(flat_dcel_t *dcel, double x, double y) {
+    if (dcel->num_vertex == dcel->size_vertex) {
+        FlatDetachMap(dcel);
+        dcel->size_vertex*=2;
+        dcel->xs = (double*)Grow(dcel->xs, sizeof(double), dcel->size_vertex);
+        dcel->ys = (double*)Grow(dcel->ys, sizeof(double), dcel->size_vertex);
+    }
+    dcel->xs[dcel->num_vertex] = x;
+    dcel->ys[dcel->num_vertex] = y;
+    return dcel->num_vertex++;
+}
+
+// Returns the index of the new face
+int FlatAddFace(flat_dcel_t *dcel) {
+    if (dcel->num_face == dcel->size_face) {
+        FlatDetachMap(dcel);
+        dcel->size_face*=2;
+        dcel->face_hedge = (int32_t*)
+            Grow(dcel->face_hedge, sizeof(int32_t), dcel->size_face);
+        dcel->face_box = (double*)
+            Grow(dcel->face_box, 4*sizeof(double), dcel->size_face);
+    }
+    dcel->face_hedge[dcel->num_face] = -1;
+    memset(dcel->face_box + 4*dcel->num_face, 0, 4*sizeof(double));
+    return dcel->num_face++;
+}
+
+// Adds half-edges v_s-->v_e having face f1 and v_e-->v_s having face f2,
+// and returns the index of the first one. Its twin is the index plus one.
+int FlatAddEdge(flat_dcel_t *dcel, int v_s, int v_e, int f1, int f2) {
+    if (dcel->num_hedge == dcel->size_hedge) {
+        FlatDetachMap(dcel);
+        int size = dcel->size_hedge*=2;
+        dcel->h_start = (int32_t*)Grow(dcel->h_start, sizeof(int32_t), size);
+        dcel->h_face = (int32_t*)Grow(dcel->h_face, sizeof(int32_t), size);
+        dcel->h_next = (int32_t*)Grow(dcel->h_next, sizeof(int32_t), size);
+        dcel->h_prev = (int32_t*)Grow(dcel->h_prev, sizeof(int32_t), size);
+    }
+    int h = dcel->num_hedge;
+    dcel->h_start[h] = v_s;
+    dcel->h_face[h] = f1;
+    dcel->h_start[h+1] = v_e;
+    dcel->h_face[h+1] = f2;
+    dcel->h_next[h] = dcel->h_prev[h] = -1;
+    dcel->h_next[h+1] = dcel->h_prev[h+1] = -1;
+    dcel->num_hedge += 2;
+    return h;
+}
+
+//==============================================================================
+// Reads the file containing the vertices of the polygon
+// and constructs a flat DCEL
+//==============================================================================
+void FlatFirstPolygon(flat_dcel_t *dcel, FILE *file) {
+    // Add all vertices
+    double X, Y;
+    while (fscanf(file, "%lf %lf", &X, &Y) > 0) {
+        FlatAddVertex(dcel, X, Y);
+    }
+    FlatClosePolygon(dcel);
+}
+
+// Adds the first face, and an edge from every vertex to the next, so the
+// vertices added so far become the polygon's boundary
+void FlatClosePolygon(flat_dcel_t *dcel) {
+    // Add 1 face and all edges, edge i owns half-edges 2i and 2i+1
+    FlatAddFace(dcel);
+    int i;
+    int n = dcel->num_vertex;
+    for (i=0;i<n;i++) {
+        FlatAddEdge(dcel, i, (i+1)%n, 0, EXTERIOR_FACE);
+    }
+
+    // Link half edges, assuming that the polygon's vertices are oriented clockwise
+    dcel->face_hedge[0] = 0;
+    for (i=0;i<n;i++) {
+        dcel->h_next[2*i] = 2*((i+1)%n);
+        dcel->h_prev[2*i] = 2*((n+i-1)%n);
+        dcel->h_next[2*i+1] = 2*((n+i-1)%n) + 1;
+        dcel->h_prev[2*i+1] = 2*((i+1)%n) + 1;
+    }
+    FlatFitFaceBox(dcel, 0);
+}
+
+// Sets the bounding box of face f to exactly cover its vertices
+void FlatFitFaceBox(flat_dcel_t *dcel, int f) {
+    double *box = dcel->face_box + 4*f;
+    int start = dcel->face_hedge[f];
+    int h = start;
+    box[0] = box[2] = dcel->xs[dcel->h_start[start]];
+    box[1] = box[3] = dcel->ys[dcel->h_start[start]];
+    do {
+        double x = dcel->xs[dcel->h_start[h]];
+        double y = dcel->ys[dcel->h_start[h]];
+        if (x < box[0]) box[0] = x;
+        if (y < box[1]) box[1] = y;
+        if (x > box[2]) box[2] = x;
+        if (y > box[3]) box[3] = y;
+        h = dcel->h_next[h];
+    } while (h != start);
+}
+
+// Same as WidenBox in dcel_ops.c
+static void WidenBox(double *box, double x, double y) {
+    if (x < box[0]) box[0] = x;
+    if (y < box[1]) box[1] = y;
+    if (x > box[2]) box[2] = x;
+    if (y > box[3]) box[3] = y;
+}
+
+// Same as EmptyFaceBox in dcel_ops.c
+static void FlatEmptyFaceBox(flat_dcel_t *dcel, int f) {
+    double *box = dcel->face_box + 4*f;
+    box[0] = box[1] = INFINITY;
+    box[2] = box[3] = -INFINITY;
+}
+
+// Same as SplitWts in dcel_ops.c
+static void FlatSplitWts(flat_dcel_t *dcel, int face_old, int face_new,
+    double Mx, double My, double Nx, double Ny) {
+    double *ring = NULL;
+    int n = 0;
+    if (FaceWtsNeedRing(dcel->face_wts, face_old)) {
+        int start = dcel->face_hedge[face_new];
+        int h = start;
+        do {
+            n++;
+            h = dcel->h_next[h];
+        } while (h != start);
+        if ( (ring = (double*)malloc(sizeof(double)*2*n)) == NULL ) {
+            printf("malloc() error\n");
+            exit(EXIT_FAILURE);
+        }
+        n = 0;
+        do {
+            ring[2*n] = dcel->xs[dcel->h_start[h]];
+            ring[2*n+1] = dcel->ys[dcel->h_start[h]];
+            n++;
+            h = dcel->h_next[h];
+        } while (h != start);
+    }
+    SplitFaceWts(dcel->face_wts, face_old, face_new, Mx, My, Nx, Ny, ring, n);
+    free(ring);
+}
+
+//==============================================================================
+// Bisects two edges, which adds 2 vertices + the edge which does the bisection
+// + a face. Follows SplitHedges in dcel_ops.c step for step, including how
+// how order bounds the work by the smaller side and keeps the face numbers.
+// Returns the index of the new face.
+//==============================================================================
+static int FlatSplitHedges(flat_dcel_t *dcel, int AM, int ND,
+    double Mx, double My, double Nx, double Ny, int *order) {
+
+    STAT_ADD(split_faces, 1);
+
+    // Add M and N
+    int m_i = FlatAddVertex(dcel, Mx, My);
+    int n_i = FlatAddVertex(dcel, Nx, Ny);
+
+    // face indices
+    int face_old = dcel->h_face[AM];
+    int face_out1 = dcel->h_face[FLAT_TWIN(AM)];
+    int face_out2 = dcel->h_face[FLAT_TWIN(ND)];
+    int face_new = FlatAddFace(dcel);
+
+    // The arrays may move whenever an edge is added, so every access below
+    // goes through dcel rather than through cached pointers.
+
+    // 1st edge
+    // add M-->N
+    int MN = FlatAddEdge(dcel, m_i, n_i, face_old, face_new);
+    dcel->face_hedge[face_old] = MN;
+    dcel->face_hedge[face_new] = FLAT_TWIN(MN);
+
+    // Pre-processing for 2nd edge
+    // change A-->B into A-->M
+    int e1B = FLAT_END(dcel, AM);
+    int old_next_hedge = dcel->h_next[AM];
+    int old_prev_hedge_twin = dcel->h_prev[FLAT_TWIN(AM)];
+    dcel->h_start[FLAT_TWIN(AM)] = m_i;
+    dcel->h_next[AM] = MN;
+    dcel->h_prev[MN] = AM;
+
+    // 2nd edge
+    // add M-->B
+    int MB = FlatAddEdge(dcel, m_i, e1B, face_new, face_out1);
+    dcel->h_next[MB] = old_next_hedge;
+    dcel->h_prev[old_next_hedge] = MB;
+    dcel->h_prev[MB] = FLAT_TWIN(MN);
+    dcel->h_next[FLAT_TWIN(MN)] = MB;
+    dcel->h_prev[FLAT_TWIN(MB)] = old_prev_hedge_twin;
+    dcel->h_next[old_prev_hedge_twin] = FLAT_TWIN(MB);
+    dcel->h_next[FLAT_TWIN(MB)] = FLAT_TWIN(AM);
+    dcel->h_prev[FLAT_TWIN(AM)] = FLAT_TWIN(MB);
+
+    // Pre-processing for 3rd edge
+    // change C-->D into N-->D
+    int e2A = dcel->h_start[ND];
+    int old_prev_hedge = dcel->h_prev[ND];
+    int old_next_hedge_twin = dcel->h_next[FLAT_TWIN(ND)];
+    dcel->h_start[ND] = n_i;
+    dcel->h_prev[ND] = MN;
+    dcel->h_next[MN] = ND;
+
+    // 3rd edge
+    // add C-->N
+    int CN = FlatAddEdge(dcel, e2A, n_i, face_new, face_out2);
+    dcel->h_prev[CN] = old_prev_hedge;
+    dcel->h_next[old_prev_hedge] = CN;
+    dcel->h_next[CN] = FLAT_TWIN(MN);
+    dcel->h_prev[FLAT_TWIN(MN)] = CN;
+    dcel->h_next[FLAT_TWIN(CN)] = old_next_hedge_twin;
+    dcel->h_prev[old_next_hedge_twin] = FLAT_TWIN(CN);
+    dcel->h_prev[FLAT_TWIN(CN)] = FLAT_TWIN(ND);
+    dcel->h_next[FLAT_TWIN(ND)] = FLAT_TWIN(CN);
+
+    // Walk both sides in lockstep, so finding the smaller side costs
+    // no more than walking it, then follow the larger side a bounded way on.
+    // Each side's box is widened as it is walked, so neither side needs
+    // walking again to fit its box.
+    int h = MB;
+    int k = ND;
+    int unwalked = 0;
+    double box_h[4] = {Nx, Ny, Nx, Ny};
+    double box_k[4] = {Mx, My, Mx, My};
+    if (order) {
+        int budget = SPLIT_SLACK;
+        order[face_new] = face_new;
+        WidenBox(box_h, dcel->xs[dcel->h_start[CN]], dcel->ys[dcel->h_start[CN]]);
+        WidenBox(box_k, dcel->xs[dcel->h_start[AM]], dcel->ys[dcel->h_start[AM]]);
+        while (h != CN && k != AM) {
+            WidenBox(box_h, dcel->xs[dcel->h_start[h]], dcel->ys[dcel->h_start[h]]);
+            WidenBox(box_k, dcel->xs[dcel->h_start[k]], dcel->ys[dcel->h_start[k]]);
+            h = dcel->h_next[h];
+            k = dcel->h_next[k];
+            budget += SPLIT_SLACK;
+            STAT_ADD(split_hedges, 2);
+        }
+        for (;h != CN && budget > 0;budget--) {
+            WidenBox(box_h, dcel->xs[dcel->h_start[h]], dcel->ys[dcel->h_start[h]]);
+            h = dcel->h_next[h];
+            STAT_ADD(split_hedges, 1);
+        }
+        for (;k != AM && budget > 0;budget--) {
+            WidenBox(box_k, dcel->xs[dcel->h_start[k]], dcel->ys[dcel->h_start[k]]);
+            k = dcel->h_next[k];
+            STAT_ADD(split_hedges, 1);
+        }
+        unwalked = h != CN || k != AM;
+    }
+
+    if (unwalked && h != CN) {
+        // the side after M-->B is too long to relabel, so the side
+        // after N-->D becomes the new face
+        dcel->h_face[MN] = face_new;
+        for (k=ND;k!=MN;k=dcel->h_next[k]) {
+            dcel->h_face[k] = face_new;
+            STAT_ADD(split_hedges, 1);
+        }
+        dcel->h_face[FLAT_TWIN(MN)] = dcel->h_face[MB] = dcel->h_face[CN] = face_old;
+        dcel->face_hedge[face_old] = FLAT_TWIN(MN);
+        dcel->face_hedge[face_new] = MN;
+        // the two sides swap numbers when the faces are renumbered
+        order[face_new] = order[face_old];
+        order[face_old] = face_new;
+        memcpy(dcel->face_box + 4*face_new, box_k, sizeof(box_k));
+        FlatEmptyFaceBox(dcel, face_old);
+        if (dcel->face_wts) {
+            FlatSplitWts(dcel, face_old, face_new, Nx, Ny, Mx, My);
+        }
+        return face_new;
+    }
+
+    // update faces
+    for (h=MB;h!=CN;h=dcel->h_next[h]) {
+        dcel->h_face[h] = face_new;
+        STAT_ADD(split_hedges, 1);
+    }
+    if (order == NULL) {
+        FlatFitFaceBox(dcel, face_new);
+        FlatFitFaceBox(dcel, face_old);
+    } else {
+        memcpy(dcel->face_box + 4*face_new, box_h, sizeof(box_h));
+        if (unwalked) {
+            FlatEmptyFaceBox(dcel, face_old);
+        } else {
+            memcpy(dcel->face_box + 4*face_old, box_k, sizeof(box_k));
+        }
+    }
+
+    // move the watchtowers now on the new face's side of M-->N
+    if (dcel->face_wts) {
+        FlatSplitWts(dcel, face_old, face_new, Mx, My, Nx, Ny);
+    }
+    return face_new;
+}
+
+// Same as PointAlong in dcel_ops.c
+static double PointAlong(double a, double b, double t) {
+    return t == 0.5 ? (a + b) / 2 : a + t * (b - a);
+}
+
+// Same as SplitThrough in dcel_ops.c
+static int FlatSplitThrough(flat_dcel_t *dcel, int AM, int ND,
+    double Mx, double My, double Nx, double Ny, int *order) {
+    double Px = (Mx + Nx) / 2;
+    double Py = (My + Ny) / 2;
+    if (!FlatHalfPlane(dcel, dcel->h_start[AM], FLAT_END(dcel, AM), Px, Py)) {
+        AM = FLAT_TWIN(AM);
+    }
+    if (!FlatHalfPlane(dcel, dcel->h_start[ND], FLAT_END(dcel, ND), Px, Py)) {
+        ND = FLAT_TWIN(ND);
+    }
+    if (dcel->h_face[AM] != dcel->h_face[ND] || dcel->h_face[AM] == EXTERIOR_FACE) {
+        return -1;
+    }
+    return FlatSplitHedges(dcel, AM, ND, Mx, My, Nx, Ny, order);
+}
+
+// Same as SplitFace in dcel_ops.c
+int FlatSplitFace(flat_dcel_t *dcel, int e1, int e2, int *order) {
+    // Twins are implicit, so no edge record needs to be rewritten
+    // when the other half-edge of an edge turns out to be in the face.
+    // M is the midpoint of AB and N is the midpoint of CD
+    int AM = 2*e1;
+    int ND = 2*e2;
+    return FlatSplitThrough(dcel, AM, ND,
+        (dcel->xs[dcel->h_start[AM]] + dcel->xs[FLAT_END(dcel, AM)]) / 2,
+        (dcel->ys[dcel->h_start[AM]] + dcel->ys[FLAT_END(dcel, AM)]) / 2,
+        (dcel->xs[dcel->h_start[ND]] + dcel->xs[FLAT_END(dcel, ND)]) / 2,
+        (dcel->ys[dcel->h_start[ND]] + dcel->ys[FLAT_END(dcel, ND)]) / 2, order);
+}
+
+// Same as SplitFaceAt in dcel_ops.c
+int FlatSplitFaceAt(flat_dcel_t *dcel, int e1, double t1, int e2, double t2, int *order) {
+    int num_edge = dcel->num_hedge / 2;
+    if (e1 == e2 || e1 < 0 || e2 < 0 || e1 >= num_edge || e2 >= num_edge ||
+        !(t1 > 0 && t1 < 1) || !(t2 > 0 && t2 < 1)) {
+        return -1;
+    }
+    int AM = 2*e1;
+    int ND = 2*e2;
+    double Ax = dcel->xs[dcel->h_start[AM]], Ay = dcel->ys[dcel->h_start[AM]];
+    double Bx = dcel->xs[FLAT_END(dcel, AM)], By = dcel->ys[FLAT_END(dcel, AM)];
+    double Cx = dcel->xs[dcel->h_start[ND]], Cy = dcel->ys[dcel->h_start[ND]];
+    double Dx = dcel->xs[FLAT_END(dcel, ND)], Dy = dcel->ys[FLAT_END(dcel, ND)];
+    return FlatSplitThrough(dcel, AM, ND, PointAlong(Ax, Bx, t1), PointAlong(Ay, By, t1),
+        PointAlong(Cx, Dx, t2), PointAlong(Cy, Dy, t2), order);
+}
+
+// Same as RenumberFaces in dcel_ops.c
+void FlatRenumberFaces(flat_dcel_t *dcel, int *order) {
+    int h, f, moved = 0;
+    for (f=0;f<dcel->num_face;f++) {
+        moved |= order[f] != f;
+    }
+    if (moved) {
+        for (h=0;h<dcel->num_hedge;h++) {
+            if (dcel->h_face[h] != EXTERIOR_FACE) {
+                dcel->h_face[h] = order[dcel->h_face[h]];
+            }
+        }
+        if (dcel->face_wts) {
+            RenumberFaceWts(dcel->face_wts, order);
+        }
+        for (f=0;f<dcel->num_face;f++) {
+            while (order[f] != f) {
+                int g = order[f];
+                int32_t hedge = dcel->face_hedge[g];
+                double box[4];
+                memcpy(box, dcel->face_box + 4*g, sizeof(box));
+                dcel->face_hedge[g] = dcel->face_hedge[f];
+                memcpy(dcel->face_box + 4*g, dcel->face_box + 4*f, sizeof(box));
+                dcel->face_hedge[f] = hedge;
+                memcpy(dcel->face_box + 4*f, box, sizeof(box));
+                order[f] = order[g];
+                order[g] = g;
+            }
+        }
+    }
+    for (f=0;f<dcel->num_face;f++) {
+        if (dcel->face_box[4*f] > dcel->face_box[4*f+2]) {
+            FlatFitFaceBox(dcel, f);
+        }
+    }
+}
+
+// Returns 1 if P is in the same half plane as the half edge A-->B, otherwise returns 0
+// Same test as HalfPlane in dcel_ops.c
+int FlatHalfPlane(flat_dcel_t *dcel, int v1, int v2, double Px, double Py) {
+    double Ax = dcel->xs[v1];
+    double Ay = dcel->ys[v1];
+    double Bx = dcel->xs[v2];
+    double By = dcel->ys[v2];
+    STAT_ADD_SHARED(half_plane, 1);
+    return Orient2d(Ax, Ay, Bx, By, Px, Py) > 0;
+}
+
+// Free the flat DCEL and its arrays
+void FreeFlatDcel(flat_dcel_t *dcel) {
+    if (dcel->map) {
+        munmap(dcel->map, dcel->map_len);
+        free(dcel);
+        return;
+    }
+    if (dcel->block) {
+        free(dcel->block);
+        free(dcel);
+        return;
+    }
+    free(dcel->xs);
+    free(dcel->ys);
+    free(dcel->face_hedge);
+    free(dcel->face_box);
+    free(dcel->h_start);
+    free(dcel->h_face);
+    free(dcel->h_next);
+    free(dcel->h_prev);
+    free(dcel);
+}
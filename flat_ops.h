@@ -0,0 +1,76 @@
+#ifndef FLAT_OPS_H
+#define FLAT_OPS_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include "pop_ops.h"
+
+// A DCEL laid out as a structure of arrays.
+// Vertices are split into x and y arrays, and half-edges refer to each other
+// by 32-bit index instead of by pointer. The two half-edges of edge e are
+// stored at 2e and 2e+1, so a half-edge's twin is found by flipping the low bit.
+// Only the start of each half-edge is stored, as it is where its twin ends.
+#define FLAT_TWIN(h) ((h) ^ 1)
+#define FLAT_EDGE(h) ((h) >> 1)
+#define FLAT_END(dcel, h) ((dcel)->h_start[FLAT_TWIN(h)])
+
+typedef struct {
+    int num_vertex;
+    int size_vertex;
+    double *xs;
+    double *ys;
+    int num_face;
+    int size_face;
+    int32_t *face_hedge;
+    // bounding box of face f at face_box[4f..4f+3]: min x, min y, max x, max y,
+    // always containing the face except during a batch of splits, as in dcel_t
+    double *face_box;
+    // num_hedge is always twice the number of edges
+    int num_hedge;
+    int size_hedge;
+    int32_t *h_start;
+    int32_t *h_face;
+    int32_t *h_next;
+    int32_t *h_prev;
+    // if set, kept up to date by FlatSplitFace, but not owned by the DCEL
+    face_wts_t *face_wts;
+    // if set, the arrays point into this mapping of a snapshot file rather
+    // than being allocated, until the DCEL first has to grow
+    void *map;
+    size_t map_len;
+    // if set, the arrays are carved out of this single allocation rather
+    // than allocated one by one, until the DCEL first has to grow
+    void *block;
+} flat_dcel_t;
+
+flat_dcel_t *CreateFlatDcel();
+
+flat_dcel_t *CreateSizedFlatDcel(int num_vertex, int num_face, int num_hedge);
+
+void FlatDetachMap(flat_dcel_t *dcel);
+
+void FlatReserveDcel(flat_dcel_t *dcel, int num_vertex, int num_face, int num_hedge);
+
+int FlatAddVertex(flat_dcel_t *dcel, double x, double y);
+
+int FlatAddFace(flat_dcel_t *dcel);
+
+int FlatAddEdge(flat_dcel_t *dcel, int v_s, int v_e, int f1, int f2);
+
+void FlatFirstPolygon(flat_dcel_t *dcel, FILE *file);
+
+void FlatClosePolygon(flat_dcel_t *dcel);
+
+void FlatFitFaceBox(flat_dcel_t *dcel, int f);
+
+int FlatSplitFace(flat_dcel_t *dcel, int e1, int e2, int *order);
+
+int FlatSplitFaceAt(flat_dcel_t *dcel, int e1, double t1, int e2, double t2, int *order);
+
+void FlatRenumberFaces(flat_dcel_t *dcel, int *order);
+
+int FlatHalfPlane(flat_dcel_t *dcel, int v1, int v2, double Px, double Py);
+
+void FreeFlatDcel(flat_dcel_t *dcel);
+
+#endif
@@ -0,0 +1,347 @@
+// frozen_ops.c
+// Freezes a fully split DCEL into flat per-face edge arrays
+
+// Handles the following:
+// - Copying every face's half-edges out of either DCEL layout, in ring order
+// - Finding which faces are convex, and bucketing the edges of the others
+//       into horizontal slabs
+// - Checking packed watchtowers against a frozen face, for classification
+// - Checking a single point against a frozen face, and finding its face
+// - Freeing a frozen DCEL
+// Once frozen, checking a face walks a few contiguous arrays instead of
+// following next links and looking up both ends of every half-edge.
+// A point is in a convex face when it is strictly inside every edge's half
+// plane. That check is wrong for a face with a reflex vertex, which
+// FirstPolygon will happily build from an irregular polygon, so those faces
+// are checked by winding number instead, with the same strictness: a point
+// on the boundary is in neither face.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "frozen_ops.h"
+#include "hplane_ops.h"
+#include "orient_ops.h"
+#include "stats_ops.h"
+
+// Most slab list entries per edge of a non-convex face, beyond its own
+#define SLAB_FILL 2
+
+// Returns pointer to a frozen DCEL with room for the given numbers of
+// faces and half-edges
+static frozen_dcel_t *CreateFrozenDcel(int num_face, int num_hedge) {
+    frozen_dcel_t *frozen;
+    if ( (frozen = (frozen_dcel_t*)malloc(sizeof(frozen_dcel_t))) == NULL ||
+         (frozen->face_start = (int*)malloc(sizeof(int)*(num_face+1))) == NULL ||
+         (frozen->ax = (double*)malloc(sizeof(double)*6*(num_hedge+1))) == NULL ) {
+        printf("malloc() error\n");
+        exit(EXIT_FAILURE);
+    }
+    // all six coordinate arrays share one block
+    frozen->ay = frozen->ax + (num_hedge+1);
+    frozen->dx = frozen->ay + (num_hedge+1);
+    frozen->dy = frozen->dx + (num_hedge+1);
+    frozen->bx = frozen->dy + (num_hedge+1);
+    frozen->by = frozen->bx + (num_hedge+1);
+    frozen->num_face = num_face;
+    frozen->num_hedge = 0;
+    return frozen;
+}
+
+// Appends half-edge A-->B to the frozen DCEL
+static void AddFrozenHedge(frozen_dcel_t *frozen, double Ax, double Ay,
+    double Bx, double By) {
+    int e = frozen->num_hedge++;
+    frozen->ax[e] = Ax;
+    frozen->ay[e] = Ay;
+    frozen->bx[e] = Bx;
+    frozen->by[e] = By;
+    frozen->dx[e] = Bx - Ax;
+    frozen->dy[e] = By - Ay;
+}
+
+// Sign of the orientation of (x, y) against edge e, as Orient2d gives it.
+// Worked out in plain doubles from the edge's deltas, and only handed to
+// Orient2d when the result is within its error bound. That includes a
+// result of 0 against a bound of 0, as for a point on the line of a
+// horizontal or vertical edge, which is on the edge's line, not outside it.
+static int EdgeSide(frozen_dcel_t *frozen, int e, double x, double y) {
+    double lhs = (x - frozen->ax[e]) * frozen->dy[e];
+    double rhs = frozen->dx[e] * (y - frozen->ay[e]);
+    if (fabs(lhs - rhs) <= ORIENT_ERRBOUND_A * (fabs(lhs) + fabs(rhs))) {
+        return Orient2d(frozen->ax[e], frozen->ay[e], frozen->bx[e], frozen->by[e], x, y);
+    }
+    return lhs > rhs ? 1 : -1;
+}
+
+// Returns 1 if face f never turns away from the side its half planes keep.
+// Straight vertices, as left behind by splits, still count as convex. A
+// ring wound the other way round fails too, and so gets the winding number
+// check, which does not mind the direction.
+static int ConvexFace(frozen_dcel_t *frozen, int f) {
+    int start = frozen->face_start[f];
+    int end = frozen->face_start[f+1];
+    int e, prev = end - 1;
+    for (e=start;e<end;e++) {
+        if (Orient2d(frozen->ax[prev], frozen->ay[prev], frozen->bx[prev], frozen->by[prev],
+            frozen->bx[e], frozen->by[e]) < 0) {
+            return 0;
+        }
+        prev = e;
+    }
+    return 1;
+}
+
+// Slab of face f holding y, clamped to the face's slabs. Monotone in y, so
+// an edge whose y range covers y is always listed in the slab of y.
+static int SlabOf(frozen_dcel_t *frozen, int f, double y) {
+    int num = frozen->face_slab[f+1] - frozen->face_slab[f];
+    int s = (int)((y - frozen->slab_y[2*f]) / frozen->slab_y[2*f+1]);
+    if (s < 0) {
+        s = 0;
+    }
+    if (s >= num) {
+        s = num - 1;
+    }
+    return frozen->face_slab[f] + s;
+}
+
+// Marks the convex faces, and gives every other face up to one slab per edge
+// over its y range, listing each edge in all the slabs it passes through
+static void BucketFaces(frozen_dcel_t *frozen) {
+    int num_face = frozen->num_face;
+    if ( (frozen->convex = (unsigned char*)malloc(num_face+1)) == NULL ||
+         (frozen->face_slab = (int*)malloc(sizeof(int)*(num_face+1))) == NULL ||
+         (frozen->slab_y = (double*)malloc(sizeof(double)*2*(num_face+1))) == NULL ) {
+        printf("malloc() error\n");
+        exit(EXIT_FAILURE);
+    }
+    int f, e, s;
+    int num_slab = 0;
+    for (f=0;f<num_face;f++) {
+        int start = frozen->face_start[f];
+        int end = frozen->face_start[f+1];
+        frozen->convex[f] = ConvexFace(frozen, f);
+        frozen->face_slab[f] = num_slab;
+        frozen->slab_y[2*f] = 0;
+        frozen->slab_y[2*f+1] = 1;
+        if (frozen->convex[f]) {
+            continue;
+        }
+        double min_y = frozen->ay[start], max_y = frozen->ay[start];
+        double spans = 0;
+        for (e=start;e<end;e++) {
+            if (frozen->ay[e] < min_y) min_y = frozen->ay[e];
+            if (frozen->ay[e] > max_y) max_y = frozen->ay[e];
+            spans += fabs(frozen->dy[e]);
+        }
+        // spans / height edges cross an average height, and every slab lists
+        // about that many on top of its share, so the slabs are capped to
+        // keep the lists within SLAB_FILL times the number of edges
+        int num = end - start;
+        if (spans > 0 && SLAB_FILL * num * (max_y - min_y) / spans < num) {
+            num = 1 + (int)(SLAB_FILL * num * (max_y - min_y) / spans);
+        }
+        frozen->slab_y[2*f] = min_y;
+        if (max_y > min_y) {
+            frozen->slab_y[2*f+1] = (max_y - min_y) / num;
+        }
+        num_slab += num;
+    }
+    frozen->face_slab[num_face] = num_slab;
+
+    // count the edges of each slab, then fill them in
+    if ( (frozen->slab_start = (int*)calloc(num_slab+1, sizeof(int))) == NULL ) {
+        printf("calloc() error\n");
+        exit(EXIT_FAILURE);
+    }
+    for (f=0;f<num_face;f++) {
+        for (e=frozen->face_start[f];!frozen->convex[f] && e<frozen->face_start[f+1];e++) {
+            int lo = SlabOf(frozen, f, fmin(frozen->ay[e], frozen->by[e]));
+            int hi = SlabOf(frozen, f, fmax(frozen->ay[e], frozen->by[e]));
+            for (s=lo;s<=hi;s++) {
+                frozen->slab_start[s+1]++;
+            }
+        }
+    }
+    for (s=0;s<num_slab;s++) {
+        frozen->slab_start[s+1] += frozen->slab_start[s];
+    }
+    int *fill;
+    if ( (fill = (int*)malloc(sizeof(int)*(num_slab+1))) == NULL ||
+         (frozen->slab_edge = (int*)malloc(sizeof(int)*(frozen->slab_start[num_slab]+1))) == NULL ) {
+        printf("malloc() error\n");
+        exit(EXIT_FAILURE);
+    }
+    memcpy(fill, frozen->slab_start, sizeof(int)*(num_slab+1));
+    for (f=0;f<num_face;f++) {
+        for (e=frozen->face_start[f];!frozen->convex[f] && e<frozen->face_start[f+1];e++) {
+            int lo = SlabOf(frozen, f, fmin(frozen->ay[e], frozen->by[e]));
+            int hi = SlabOf(frozen, f, fmax(frozen->ay[e], frozen->by[e]));
+            for (s=lo;s<=hi;s++) {
+                frozen->slab_edge[fill[s]++] = e;
+            }
+        }
+    }
+    free(fill);
+}
+
+// Returns pointer to a frozen copy of the DCEL's faces
+frozen_dcel_t *FreezeDcel(dcel_t *dcel) {
+    // every edge bounds at most two faces
+    frozen_dcel_t *frozen = CreateFrozenDcel(dcel->num_face, 2*dcel->num_edge);
+    int f;
+    for (f=0;f<dcel->num_face;f++) {
+        frozen->face_start[f] = frozen->num_hedge;
+        hedge_t *start = dcel->face_list[f]->hedge;
+        hedge_t *hedge = start;
+        do {
+            vertex_t *A = dcel->vertex_list[hedge->v_start];
+            vertex_t *B = dcel->vertex_list[hedge->v_end];
+            AddFrozenHedge(frozen, A->x, A->y, B->x, B->y);
+            hedge = hedge->next;
+        } while (hedge != start);
+    }
+    frozen->face_start[dcel->num_face] = frozen->num_hedge;
+    BucketFaces(frozen);
+    return frozen;
+}
+
+// Same as FreezeDcel, on the flat layout
+frozen_dcel_t *FreezeFlatDcel(flat_dcel_t *dcel) {
+    frozen_dcel_t *frozen = CreateFrozenDcel(dcel->num_face, dcel->num_hedge);
+    int f;
+    for (f=0;f<dcel->num_face;f++) {
+        frozen->face_start[f] = frozen->num_hedge;
+        int start = dcel->face_hedge[f];
+        int h = start;
+        do {
+            int v1 = dcel->h_start[h];
+            int v2 = FLAT_END(dcel, h);
+            AddFrozenHedge(frozen, dcel->xs[v1], dcel->ys[v1], dcel->xs[v2], dcel->ys[v2]);
+            h = dcel->h_next[h];
+        } while (h != start);
+    }
+    frozen->face_start[dcel->num_face] = frozen->num_hedge;
+    BucketFaces(frozen);
+    return frozen;
+}
+
+// Returns 1 if any bit of the mask is still set
+static int AnySet(uint64_t *mask, int n) {
+    int k;
+    for (k=0;k<MASK_WORDS(n);k++) {
+        if (mask[k]) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Clears the bit in mask of every packed watchtower which is outside face f,
+// with edge_mask as scratch space of the same size. Stops early once none of
+// the watchtowers are left.
+void FrozenFaceMask(frozen_dcel_t *d, int f, double *xs, double *ys, int n,
+    uint64_t *mask, uint64_t *edge_mask) {
+    int e, k;
+    if (!d->convex[f]) {
+        for (k=0;k<n;k++) {
+            if (((mask[k >> 6] >> (k & 63)) & 1) && !FrozenInFace(d, f, xs[k], ys[k])) {
+                mask[k >> 6] &= ~((uint64_t)1 << (k & 63));
+            }
+        }
+        return;
+    }
+    int end = d->face_start[f+1];
+    for (e=d->face_start[f];e<end;e++) {
+        HalfPlaneBatchDelta(d->ax[e], d->ay[e], d->bx[e], d->by[e], d->dx[e], d->dy[e],
+            xs, ys, n, edge_mask);
+        for (k=0;k<MASK_WORDS(n);k++) {
+            mask[k] &= edge_mask[k];
+        }
+        if (!AnySet(mask, n)) {
+            break;
+        }
+    }
+}
+
+// Returns 1 if (x, y) is strictly inside the non-convex face f. Only edges
+// whose y range holds y can cross the rightward ray from the point, and
+// those are all listed in the point's slab. Edges going up past the point
+// with it on their left add one, edges going down with it on their right
+// take one away, and the point is inside when they do not cancel out.
+static int WindingInFace(frozen_dcel_t *frozen, int f, double x, double y) {
+    int s = SlabOf(frozen, f, y);
+    int i, winding = 0, checked = 0;
+    for (i=frozen->slab_start[s];i<frozen->slab_start[s+1];i++) {
+        int e = frozen->slab_edge[i];
+        double Ay = frozen->ay[e], By = frozen->by[e];
+        if ((y < Ay && y < By) || (y > Ay && y > By)) {
+            continue;
+        }
+        checked++;
+        int side = EdgeSide(frozen, e, x, y);
+        if (side == 0 && x >= fmin(frozen->ax[e], frozen->bx[e]) &&
+            x <= fmax(frozen->ax[e], frozen->bx[e])) {
+            // on the boundary
+            winding = 0;
+            break;
+        }
+        if (Ay <= y) {
+            if (By > y && side < 0) {
+                winding++;
+            }
+        } else if (By <= y && side > 0) {
+            winding--;
+        }
+    }
+    STAT_ADD_SHARED(crossing_edges, checked);
+    return winding != 0;
+}
+
+// Returns 1 if (x, y) lies strictly inside face f of a frozen DCEL.
+// Convex faces take the half plane check of every edge, the rest the
+// winding test.
+int FrozenInFace(frozen_dcel_t *frozen, int f, double x, double y) {
+    if (!frozen->convex[f]) {
+        return WindingInFace(frozen, f, x, y);
+    }
+    int e;
+    int start = frozen->face_start[f];
+    int end = frozen->face_start[f+1];
+    for (e=start;e<end;e++) {
+        if (EdgeSide(frozen, e, x, y) <= 0) {
+            STAT_ADD_SHARED(half_plane, e - start + 1);
+            return 0;
+        }
+    }
+    STAT_ADD_SHARED(half_plane, end - start);
+    return 1;
+}
+
+// Returns the lowest indexed face containing (x, y), or -1 if there is none.
+// Faces whose bounding box misses the point are passed over untested.
+int FrozenLocateFace(face_grid_t *grid, frozen_dcel_t *frozen, double x, double y) {
+    int i, n;
+    int *faces = CellFaces(grid, x, y, &n);
+    for (i=0;i<n;i++) {
+        double *box = grid->boxes + 4*faces[i];
+        if (x >= box[0] && x <= box[2] && y >= box[1] && y <= box[3] &&
+            FrozenInFace(frozen, faces[i], x, y)) {
+            return faces[i];
+        }
+    }
+    return -1;
+}
+
+void FreeFrozenDcel(frozen_dcel_t *frozen) {
+    free(frozen->face_start);
+    free(frozen->ax);
+    free(frozen->convex);
+    free(frozen->face_slab);
+    free(frozen->slab_y);
+    free(frozen->slab_start);
+    free(frozen->slab_edge);
+    free(frozen);
+}
\ No newline at end of file
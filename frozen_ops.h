@@ -0,0 +1,51 @@
+#ifndef FROZEN_OPS_H
+#define FROZEN_OPS_H
+
+#include <stdint.h>
+#include "dcel_ops.h"
+#include "flat_ops.h"
+#include "locate_ops.h"
+
+// The half-edges of a DCEL that will not be split any further, copied out
+// face by face into flat arrays for classification and queries.
+// Face f's half-edges are e = face_start[f] to face_start[f+1]-1, in the
+// order of the face's ring, going from (ax[e], ay[e]) to (bx[e], by[e]),
+// with dx[e] = bx[e] - ax[e] and dy[e] = by[e] - ay[e] already worked out.
+// Convex faces are checked against every edge's half plane. The others are
+// cut into horizontal slabs, each listing the edges whose y range meets it,
+// and checked by winding number over the edges of the point's slab only.
+typedef struct {
+    int num_face;
+    int num_hedge;
+    int *face_start;
+    double *ax;
+    double *ay;
+    double *dx;
+    double *dy;
+    double *bx;
+    double *by;
+    // 1 for each face the half plane check can be trusted on
+    unsigned char *convex;
+    // slabs of face f are face_slab[f] to face_slab[f+1]-1, none if convex,
+    // starting at slab_y[2f] and each slab_y[2f+1] high
+    int *face_slab;
+    double *slab_y;
+    // edges in slab s are slab_edge[slab_start[s]] to slab_edge[slab_start[s+1]-1]
+    int *slab_start;
+    int *slab_edge;
+} frozen_dcel_t;
+
+frozen_dcel_t *FreezeDcel(dcel_t *dcel);
+
+frozen_dcel_t *FreezeFlatDcel(flat_dcel_t *dcel);
+
+void FrozenFaceMask(frozen_dcel_t *frozen, int f, double *xs, double *ys, int n,
+    uint64_t *mask, uint64_t *edge_mask);
+
+int FrozenInFace(frozen_dcel_t *frozen, int f, double x, double y);
+
+int FrozenLocateFace(face_grid_t *grid, frozen_dcel_t *frozen, double x, double y);
+
+void FreeFrozenDcel(frozen_dcel_t *frozen);
+
+#endif
\ No newline at end of file
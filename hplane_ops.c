@@ -0,0 +1,144 @@
+// hplane_ops.c
+// Batched half-plane checks
+
+// Tests many points against one half-edge A-->B at a time, setting bit i
+// of the mask (bit i%64 of word i/64) when point i passes.
+// The test is the one done by HalfPlane in dcel_ops.c, Orient2d > 0.
+// The vector versions evaluate
+//     (Px - Ax)*(By - Ay) - (Bx - Ax)*(Py - Ay)
+// in plain doubles, the first stage of Orient2d, and only hand the points
+// whose result is within its rounding error bound to Orient2d itself, so
+// every version agrees with it exactly. AVX2 handles 4 points per step and
+// SSE2 handles 2, with plain C for the rest and for other machines.
+// HalfPlaneBatchWith can be held to a narrower instruction set, so the
+// versions can be checked against each other on one machine.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "hplane_ops.h"
+#include "orient_ops.h"
+#include "stats_ops.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HPLANE_X86
+#endif
+
+// Scalar version, also used for the tails of the vector versions
+static void BatchRange(double Ax, double Ay, double Bx, double By,
+    const double *xs, const double *ys, int from, int to, uint64_t *mask) {
+    int i;
+    for (i=from;i<to;i++) {
+        if (Orient2d(Ax, Ay, Bx, By, xs[i], ys[i]) > 0) {
+            mask[i >> 6] |= (uint64_t)1 << (i & 63);
+        }
+    }
+}
+
+// Decides the points from first onwards flagged in unsure, which the plain
+// double test could not, and returns bits with their answers filled in
+static uint64_t Recheck(double Ax, double Ay, double Bx, double By,
+    const double *xs, const double *ys, int first, int unsure, uint64_t bits) {
+    int j;
+    for (j=0;unsure;j++, unsure >>= 1) {
+        if (!(unsure & 1)) {
+            continue;
+        }
+        if (Orient2d(Ax, Ay, Bx, By, xs[first+j], ys[first+j]) > 0) {
+            bits |= (uint64_t)1 << j;
+        } else {
+            bits &= ~((uint64_t)1 << j);
+        }
+    }
+    return bits;
+}
+
+#ifdef HPLANE_X86
+
+__attribute__((target("avx2")))
+static int BatchAVX2(double Ax, double Ay, double Bx, double By, double Dx, double Dy,
+    const double *xs, const double *ys, int n, uint64_t *mask) {
+    __m256d ax = _mm256_set1_pd(Ax);
+    __m256d ay = _mm256_set1_pd(Ay);
+    __m256d vdx = _mm256_set1_pd(Dx);
+    __m256d vdy = _mm256_set1_pd(Dy);
+    __m256d sign = _mm256_set1_pd(-0.0);
+    __m256d errbound = _mm256_set1_pd(ORIENT_ERRBOUND_A);
+    int i;
+    for (i=0;i+4<=n;i+=4) {
+        __m256d lhs = _mm256_mul_pd(_mm256_sub_pd(_mm256_loadu_pd(xs+i), ax), vdy);
+        __m256d rhs = _mm256_mul_pd(vdx, _mm256_sub_pd(_mm256_loadu_pd(ys+i), ay));
+        __m256d det = _mm256_sub_pd(lhs, rhs);
+        __m256d bound = _mm256_mul_pd(errbound,
+            _mm256_add_pd(_mm256_andnot_pd(sign, lhs), _mm256_andnot_pd(sign, rhs)));
+        uint64_t bits = (uint64_t)_mm256_movemask_pd(_mm256_cmp_pd(lhs, rhs, _CMP_GT_OQ));
+        int unsure = _mm256_movemask_pd(_mm256_cmp_pd(_mm256_andnot_pd(sign, det), bound, _CMP_LT_OQ));
+        if (unsure) {
+            bits = Recheck(Ax, Ay, Bx, By, xs, ys, i, unsure, bits);
+        }
+        mask[i >> 6] |= bits << (i & 63);
+    }
+    return i;
+}
+
+#ifdef __SSE2__
+static int BatchSSE2(double Ax, double Ay, double Bx, double By, double Dx, double Dy,
+    const double *xs, const double *ys, int n, uint64_t *mask) {
+    __m128d ax = _mm_set1_pd(Ax);
+    __m128d ay = _mm_set1_pd(Ay);
+    __m128d vdx = _mm_set1_pd(Dx);
+    __m128d vdy = _mm_set1_pd(Dy);
+    __m128d sign = _mm_set1_pd(-0.0);
+    __m128d errbound = _mm_set1_pd(ORIENT_ERRBOUND_A);
+    int i;
+    for (i=0;i+2<=n;i+=2) {
+        __m128d lhs = _mm_mul_pd(_mm_sub_pd(_mm_loadu_pd(xs+i), ax), vdy);
+        __m128d rhs = _mm_mul_pd(vdx, _mm_sub_pd(_mm_loadu_pd(ys+i), ay));
+        __m128d det = _mm_sub_pd(lhs, rhs);
+        __m128d bound = _mm_mul_pd(errbound,
+            _mm_add_pd(_mm_andnot_pd(sign, lhs), _mm_andnot_pd(sign, rhs)));
+        uint64_t bits = (uint64_t)_mm_movemask_pd(_mm_cmpgt_pd(lhs, rhs));
+        int unsure = _mm_movemask_pd(_mm_cmplt_pd(_mm_andnot_pd(sign, det), bound));
+        if (unsure) {
+            bits = Recheck(Ax, Ay, Bx, By, xs, ys, i, unsure, bits);
+        }
+        mask[i >> 6] |= bits << (i & 63);
+    }
+    return i;
+}
+#endif
+
+#endif
+
+// Sets bit i of mask if (xs[i], ys[i]) is in the half plane of A-->B,
+// using the widest instructions the machine supports.
+// (Dx, Dy) is B - A, worked out once by the caller.
+void HalfPlaneBatchDelta(double Ax, double Ay, double Bx, double By,
+    double Dx, double Dy, const double *xs, const double *ys, int n, uint64_t *mask) {
+    HalfPlaneBatchWith(HPLANE_AVX2, Ax, Ay, Bx, By, Dx, Dy, xs, ys, n, mask);
+}
+
+// Same as HalfPlaneBatchDelta, using no instruction set wider than isa, one
+// of the HPLANE_ values. Returns the instruction set actually used, which is
+// narrower than isa when the machine does not support it.
+int HalfPlaneBatchWith(int isa, double Ax, double Ay, double Bx, double By,
+    double Dx, double Dy, const double *xs, const double *ys, int n, uint64_t *mask) {
+    int done = 0, used = HPLANE_SCALAR;
+    STAT_ADD_SHARED(half_plane, n);
+    memset(mask, 0, sizeof(uint64_t)*MASK_WORDS(n));
+#ifdef HPLANE_X86
+    if (isa >= HPLANE_AVX2 && __builtin_cpu_supports("avx2")) {
+        done = BatchAVX2(Ax, Ay, Bx, By, Dx, Dy, xs, ys, n, mask);
+        used = HPLANE_AVX2;
+    }
+#ifdef __SSE2__
+    else if (isa >= HPLANE_SSE2) {
+        done = BatchSSE2(Ax, Ay, Bx, By, Dx, Dy, xs, ys, n, mask);
+        used = HPLANE_SSE2;
+    }
+#endif
+#endif
+    BatchRange(Ax, Ay, Bx, By, xs, ys, done, n, mask);
+    return used;
+}
@@ -0,0 +1,20 @@
+#ifndef HPLANE_OPS_H
+#define HPLANE_OPS_H
+
+#include <stdint.h>
+
+// Number of 64-bit mask words needed for n points
+#define MASK_WORDS(n) (((n) + 63) / 64)
+
+// Instruction sets HalfPlaneBatchWith can be held to, each wider than the last
+#define HPLANE_SCALAR 0
+#define HPLANE_SSE2 1
+#define HPLANE_AVX2 2
+
+void HalfPlaneBatchDelta(double Ax, double Ay, double Bx, double By,
+    double Dx, double Dy, const double *xs, const double *ys, int n, uint64_t *mask);
+
+int HalfPlaneBatchWith(int isa, double Ax, double Ay, double Bx, double By,
+    double Dx, double Dy, const double *xs, const double *ys, int n, uint64_t *mask);
+
+#endif
@@ -0,0 +1,190 @@
+// loadgen.c
+// Measures the latency of a voronoi1 query service
+
+// Usage: voronoi1_loadgen socket [queries] [batch]
+//
+// Connects to a service started with voronoi1 -u socket, asks it for the
+// polygon's bounding box and number of faces, then sends the given number of
+// queries in batches of batch queries, waiting for every reply to a batch
+// before sending the next. Nine in ten queries locate a random point in the
+// bounding box and the rest look up a random face's population.
+// Reports throughput and the p50, p99 and worst time for a batch to be
+// answered, and the same per query, each batch's time being shared among the
+// queries actually in it, as the last batch may be short. Queries come from a fixed seed, so
+// reports can be compared across commits.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#define DEFAULT_QUERIES 100000
+#define DEFAULT_BATCH 1
+// Longest query sent, and longest reply to a single query
+#define MAX_QUERY_LEN 64
+#define MAX_REPLY_LEN 128
+// Every tenth query is a population lookup
+#define POPULATION_EVERY 10
+#define SEED 20003
+
+static double Now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Uniform random double in [lo, hi)
+static double Uniform(double lo, double hi) {
+    return lo + (hi - lo) * (rand() / (RAND_MAX + 1.0));
+}
+
+static int CompareDouble(const void *a, const void *b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+// Writes all len bytes of buf to fd
+static void SendAll(int fd, char *buf, size_t len) {
+    while (len > 0) {
+        ssize_t done = write(fd, buf, len);
+        if (done <= 0) {
+            printf("write() error\n");
+            exit(EXIT_FAILURE);
+        }
+        buf += done;
+        len -= done;
+    }
+}
+
+// Reads from fd into buf until lines replies have arrived in full,
+// and returns the number of bytes read
+static size_t ReadReplies(int fd, char *buf, size_t size, int lines) {
+    size_t len = 0;
+    while (lines > 0) {
+        ssize_t got = read(fd, buf + len, size - len);
+        if (got <= 0) {
+            printf("read() error\n");
+            exit(EXIT_FAILURE);
+        }
+        char *p;
+        for (p=buf+len;p<buf+len+got;p++) {
+            lines -= (*p == '\n');
+        }
+        len += got;
+    }
+    return len;
+}
+
+// Sends one query and returns its reply, terminated in place of the newline
+static char *Ask(int fd, char *query, char *reply) {
+    SendAll(fd, query, strlen(query));
+    size_t len = ReadReplies(fd, reply, MAX_REPLY_LEN, 1);
+    reply[len-1] = '\0';
+    return reply;
+}
+
+// The q-th quantile of n sorted values
+static double Quantile(double *sorted, int n, double q) {
+    int k = (int)(q * (n - 1) + 0.5);
+    return sorted[k];
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        printf("Usage: %s socket [queries] [batch]\n", argv[0]);
+        return 0;
+    }
+    long queries = argc > 2 ? atol(argv[2]) : DEFAULT_QUERIES;
+    int batch = argc > 3 ? atoi(argv[3]) : DEFAULT_BATCH;
+    if (queries < 1) {
+        queries = 1;
+    }
+    if (batch < 1) {
+        batch = 1;
+    }
+    srand(SEED);
+
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, argv[1], sizeof(addr.sun_path) - 1);
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || connect(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        printf("Could not connect to %s\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+
+    char reply[MAX_REPLY_LEN];
+    double box[4];
+    if (sscanf(Ask(fd, "B\n", reply), "%lf %lf %lf %lf",
+        &box[0], &box[1], &box[2], &box[3]) != 4) {
+        printf("Unexpected reply: %s\n", reply);
+        return EXIT_FAILURE;
+    }
+    int num_face = atoi(Ask(fd, "N\n", reply));
+
+    long num_batches = (queries + batch - 1) / batch;
+    double *latency = (double*)malloc(sizeof(double)*num_batches);
+    double *per_query = (double*)malloc(sizeof(double)*num_batches);
+    char *out = (char*)malloc((size_t)MAX_QUERY_LEN * batch);
+    char *in = (char*)malloc((size_t)MAX_REPLY_LEN * batch);
+    if (latency == NULL || per_query == NULL || out == NULL || in == NULL) {
+        printf("malloc() error\n");
+        exit(EXIT_FAILURE);
+    }
+
+    long sent = 0, b;
+    long found = 0;
+    double start = Now();
+    for (b=0;b<num_batches;b++) {
+        int n = queries - sent < batch ? queries - sent : batch;
+        size_t len = 0;
+        int k;
+        for (k=0;k<n;k++) {
+            if ((sent + k) % POPULATION_EVERY == POPULATION_EVERY - 1) {
+                len += snprintf(out + len, MAX_QUERY_LEN, "P %d\n",
+                    num_face > 0 ? rand() % num_face : 0);
+            } else {
+                len += snprintf(out + len, MAX_QUERY_LEN, "F %.17g %.17g\n",
+                    Uniform(box[0], box[2]), Uniform(box[1], box[3]));
+            }
+        }
+        double t = Now();
+        SendAll(fd, out, len);
+        size_t got = ReadReplies(fd, in, (size_t)MAX_REPLY_LEN * batch, n);
+        latency[b] = Now() - t;
+        per_query[b] = latency[b] / n;
+        // count the points found to lie in a face
+        char *p = in;
+        for (k=0;k<n;k++) {
+            char *nl = (char*)memchr(p, '\n', in + got - p);
+            if ((sent + k) % POPULATION_EVERY != POPULATION_EVERY - 1 && *p != '-') {
+                found++;
+            }
+            p = nl + 1;
+        }
+        sent += n;
+    }
+    double total = Now() - start;
+    close(fd);
+
+    qsort(latency, num_batches, sizeof(double), CompareDouble);
+    qsort(per_query, num_batches, sizeof(double), CompareDouble);
+    printf("%ld queries in batches of %d against %d faces, %ld points found in a face\n",
+        queries, batch, num_face, found);
+    printf("%.3f s, %.0f queries/sec\n", total, queries / total);
+    printf("%-10s %12s %12s %12s\n", "latency", "p50 us", "p99 us", "max us");
+    printf("%-10s %12.2f %12.2f %12.2f\n", "batch", Quantile(latency, num_batches, 0.5) * 1e6,
+        Quantile(latency, num_batches, 0.99) * 1e6, latency[num_batches-1] * 1e6);
+    printf("%-10s %12.2f %12.2f %12.2f\n", "query", Quantile(per_query, num_batches, 0.5) * 1e6,
+        Quantile(per_query, num_batches, 0.99) * 1e6, per_query[num_batches-1] * 1e6);
+
+    free(latency);
+    free(per_query);
+    free(out);
+    free(in);
+    return 0;
+}
@@ -0,0 +1,191 @@
+// locate_ops.c
+// Point location over the faces of a DCEL
+
+// Handles the following:
+// - Building a uniform grid of face candidates over the polygon from the
+//       face bounding boxes kept by either DCEL layout
+// - Listing the faces which may contain a point
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "locate_ops.h"
+
+// Roughly how many grid cells to create per face
+#define CELLS_PER_FACE 2
+
+//==============================================================================
+// Grid construction
+//==============================================================================
+
+// Column/row of a coordinate, clamped to the grid.
+// Both are monotone in their argument, so a face whose bounding box
+// covers a point is always registered in the point's cell.
+static int CellCol(face_grid_t *grid, double x) {
+    int c = (int)((x - grid->min_x) / grid->cell_w);
+    if (c < 0) {
+        c = 0;
+    }
+    if (c >= grid->cols) {
+        c = grid->cols - 1;
+    }
+    return c;
+}
+
+static int CellRow(face_grid_t *grid, double y) {
+    int r = (int)((y - grid->min_y) / grid->cell_h);
+    if (r < 0) {
+        r = 0;
+    }
+    if (r >= grid->rows) {
+        r = grid->rows - 1;
+    }
+    return r;
+}
+
+// Returns pointer to a grid over the given face bounding boxes.
+// box[4f..4f+3] holds min x, min y, max x, max y of face f, and bounds holds
+// the same for the whole polygon. The grid keeps its own copy of the boxes.
+face_grid_t *BuildFaceGrid(double *boxes, int num_face, double *bounds) {
+    face_grid_t *grid;
+    if ( (grid = (face_grid_t*)malloc(sizeof(face_grid_t))) == NULL ||
+         (grid->boxes = (double*)malloc(sizeof(double)*4*(num_face+1))) == NULL ) {
+        printf("malloc() error\n");
+        exit(EXIT_FAILURE);
+    }
+    memcpy(grid->boxes, boxes, sizeof(double)*4*num_face);
+    grid->min_x = bounds[0];
+    grid->min_y = bounds[1];
+    grid->max_x = bounds[2];
+    grid->max_y = bounds[3];
+
+    // choose roughly square cells, about CELLS_PER_FACE of them per face
+    double w = grid->max_x - grid->min_x;
+    double h = grid->max_y - grid->min_y;
+    int target = CELLS_PER_FACE * (num_face > 0 ? num_face : 1);
+    if (w > 0 && h > 0) {
+        grid->cols = (int)ceil(sqrt(target * w / h));
+        grid->rows = (target + grid->cols - 1) / grid->cols;
+    } else {
+        grid->cols = grid->rows = 1;
+    }
+    grid->cell_w = (w > 0) ? w / grid->cols : 1;
+    grid->cell_h = (h > 0) ? h / grid->rows : 1;
+
+    int num_cells = grid->cols * grid->rows;
+    if ( (grid->cell_start = (int*)calloc(num_cells+1, sizeof(int))) == NULL ) {
+        printf("calloc() error\n");
+        exit(EXIT_FAILURE);
+    }
+
+    // count how many faces each cell receives
+    int i, f, r, c;
+    for (f=0;f<num_face;f++) {
+        double *box = boxes + 4*f;
+        for (r=CellRow(grid, box[1]);r<=CellRow(grid, box[3]);r++) {
+            for (c=CellCol(grid, box[0]);c<=CellCol(grid, box[2]);c++) {
+                grid->cell_start[r*grid->cols + c + 1]++;
+            }
+        }
+    }
+    for (i=0;i<num_cells;i++) {
+        grid->cell_start[i+1] += grid->cell_start[i];
+    }
+
+    // fill in the cells, faces end up in ascending order within each cell
+    int *fill;
+    if ( (fill = (int*)malloc(sizeof(int)*(num_cells+1))) == NULL ||
+         (grid->cell_faces = (int*)malloc(sizeof(int)*(grid->cell_start[num_cells]+1))) == NULL ) {
+        printf("malloc() error\n");
+        exit(EXIT_FAILURE);
+    }
+    for (i=0;i<num_cells;i++) {
+        fill[i] = grid->cell_start[i];
+    }
+    for (f=0;f<num_face;f++) {
+        double *box = boxes + 4*f;
+        for (r=CellRow(grid, box[1]);r<=CellRow(grid, box[3]);r++) {
+            for (c=CellCol(grid, box[0]);c<=CellCol(grid, box[2]);c++) {
+                grid->cell_faces[fill[r*grid->cols + c]++] = f;
+            }
+        }
+    }
+
+    free(fill);
+    return grid;
+}
+
+// Widens box (min x, min y, max x, max y) to cover (x, y)
+static void CoverPoint(double *box, double x, double y, int first) {
+    if (first || x < box[0]) box[0] = x;
+    if (first || y < box[1]) box[1] = y;
+    if (first || x > box[2]) box[2] = x;
+    if (first || y > box[3]) box[3] = y;
+}
+
+// Returns pointer to a grid covering every face of the DCEL
+face_grid_t *CreateFaceGrid(dcel_t *dcel) {
+    double bounds[4] = {0, 0, 0, 0};
+    double *boxes;
+    if ( (boxes = (double*)malloc(sizeof(double)*4*(dcel->num_face+1))) == NULL ) {
+        printf("malloc() error\n");
+        exit(EXIT_FAILURE);
+    }
+    int i, f;
+    for (i=0;i<dcel->num_vertex;i++) {
+        CoverPoint(bounds, dcel->vertex_list[i]->x, dcel->vertex_list[i]->y, i == 0);
+    }
+    for (f=0;f<dcel->num_face;f++) {
+        memcpy(boxes + 4*f, dcel->face_list[f]->box, sizeof(double)*4);
+    }
+    face_grid_t *grid = BuildFaceGrid(boxes, dcel->num_face, bounds);
+    free(boxes);
+    return grid;
+}
+
+// Returns pointer to a grid covering every face of the flat DCEL
+face_grid_t *CreateFlatFaceGrid(flat_dcel_t *dcel) {
+    double bounds[4] = {0, 0, 0, 0};
+    int i;
+    for (i=0;i<dcel->num_vertex;i++) {
+        CoverPoint(bounds, dcel->xs[i], dcel->ys[i], i == 0);
+    }
+    return BuildFaceGrid(dcel->face_box, dcel->num_face, bounds);
+}
+
+//==============================================================================
+// Queries
+//==============================================================================
+
+// Returns the cell containing (x, y), or -1 if the point is outside the
+// polygon's bounding box and so cannot be in any face
+int PointCell(face_grid_t *grid, double x, double y) {
+    if (x < grid->min_x || x > grid->max_x || y < grid->min_y || y > grid->max_y) {
+        return -1;
+    }
+    return CellRow(grid, y)*grid->cols + CellCol(grid, x);
+}
+
+// Returns the faces registered in a cell and sets n to how many there are
+int *CellList(face_grid_t *grid, int cell, int *n) {
+    *n = grid->cell_start[cell+1] - grid->cell_start[cell];
+    return grid->cell_faces + grid->cell_start[cell];
+}
+
+// Returns the faces which may contain (x, y) and sets n to how many there are
+int *CellFaces(face_grid_t *grid, double x, double y, int *n) {
+    int cell = PointCell(grid, x, y);
+    if (cell < 0) {
+        *n = 0;
+        return grid->cell_faces;
+    }
+    return CellList(grid, cell, n);
+}
+
+void FreeFaceGrid(face_grid_t *grid) {
+    free(grid->cell_start);
+    free(grid->cell_faces);
+    free(grid->boxes);
+    free(grid);
+}
@@ -0,0 +1,40 @@
+#ifndef LOCATE_OPS_H
+#define LOCATE_OPS_H
+
+#include "dcel_ops.h"
+#include "flat_ops.h"
+
+// A uniform grid laid over the bounding box of the DCEL's vertices.
+// Each cell lists the faces whose bounding boxes overlap it, so a point
+// only needs to be tested against the few faces registered in its cell.
+typedef struct {
+    double min_x;
+    double min_y;
+    double max_x;
+    double max_y;
+    double cell_w;
+    double cell_h;
+    int cols;
+    int rows;
+    // faces in cell c are cell_faces[cell_start[c]] to cell_faces[cell_start[c+1]-1]
+    int *cell_start;
+    int *cell_faces;
+    // copy of the face bounding boxes the grid was built from, 4 per face
+    double *boxes;
+} face_grid_t;
+
+face_grid_t *BuildFaceGrid(double *boxes, int num_face, double *bounds);
+
+face_grid_t *CreateFaceGrid(dcel_t *dcel);
+
+face_grid_t *CreateFlatFaceGrid(flat_dcel_t *dcel);
+
+int PointCell(face_grid_t *grid, double x, double y);
+
+int *CellList(face_grid_t *grid, int cell, int *n);
+
+int *CellFaces(face_grid_t *grid, double x, double y, int *n);
+
+void FreeFaceGrid(face_grid_t *grid);
+
+#endif
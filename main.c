@@ -9,104 +9,328 @@
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
+#include <time.h>
+#include <unistd.h>
 #include "wt_ops.h"
 #include "dcel_ops.h"
+#include "flat_ops.h"
+#include "locate_ops.h"
+#include "classify_ops.h"
+#include "split_ops.h"
+#include "output_ops.h"
+#include "snapshot_ops.h"
+#include "stream_ops.h"
+#include "stats_ops.h"
+#include "query_ops.h"
+#include "batch_ops.h"
+#include "frozen_ops.h"
 
-void CreateOutput(FILE *file, dcel_t *dcel, wt_info_t **wts, int n);
+// Options given on the command line, anywhere among the file names
+typedef struct {
+    int flat;        // -f: build the flat (structure of arrays) DCEL instead
+    int threads;     // -j N: load and classify watchtowers with N threads
+    char *split_file; // -s FILE: read splits from FILE instead of stdin
+    int incremental; // -i: keep face populations up to date during the splits
+    int throughput;  // -t: report split throughput on stderr
+    char *save_file; // -w FILE: save a snapshot of the DCEL after the splits
+    char *load_file; // -l FILE: load the DCEL from a snapshot, as the flat
+                     //     layout, instead of building it. No polygon file is
+                     //     given, and splits are only read if -s is given.
+    int chunk;       // -c N: stream the watchtowers N at a time instead of
+                     //     loading them all, ignoring -i
+    int stats;       // --stats: print phase timings and counters as JSON on
+                     //     stderr, as does setting VORONOI_STATS
+    int query;       // -q: answer queries from stdin on stdout instead of
+                     //     writing output. No output file is given, splits
+                     //     are only read if -s is given, and -i and -c are
+                     //     ignored.
+    char *socket_file; // -u FILE: as -q, but answer queries from clients of
+                       //     a Unix socket at FILE
+    char *batch_file; // -b FILE: build the DCEL once, then classify every
+                      //     watchtower csv listed in FILE, one "input output"
+                      //     pair per line. Only the polygon file is given, -j N
+                      //     works on N files at once, and -i, -c, -q and -u
+                      //     are ignored.
+    char *files[3];  // watchtower csv, polygon, output
+} options_t;
+
+int ParseOptions(int argc, char **argv, options_t *opts);
+double Seconds();
 
 int main(int argc, char **argv) {
 
-    if (argc<4) {
+    options_t opts;
+    int num_files = ParseOptions(argc, argv, &opts);
+    if (opts.batch_file) {
+        // the watchtower and output files all come from the batch file,
+        // so the only file given is the polygon
+        opts.query = 0;
+        opts.chunk = 0;
+        opts.incremental = 0;
+        opts.files[1] = opts.files[0];
+        opts.files[0] = NULL;
+    }
+    // Answering queries needs no output file, and a batch only the polygon
+    int needed = opts.batch_file ? 1 : opts.query ? 2 : 3;
+    if (opts.load_file && num_files == needed-1) {
+        // the output file takes the polygon file's place
+        opts.files[2] = opts.files[1];
+        opts.files[1] = NULL;
+        opts.flat = 1;
+    } else if (num_files < needed) {
         printf("Insufficient input\n");
         return 0;
     }
+    if (opts.query) {
+        opts.chunk = 0;
+        opts.incremental = 0;
+    }
 
     // Obtain watchtower data and no. of watchtowers
+    // The file is memory-mapped and parsed into a columnar table, unless it
+    // is streamed
+    double phase = STAT_NOW();
     FILE *file;
-    if ((file = fopen(argv[1], "r")) == NULL) {
-        printf("File 1 not found\n");
-        return 0;
+    FILE *wt_stream = NULL;
+    wt_table_t *watchtowers = NULL;
+    if (opts.batch_file) {
+        // each job loads its own watchtowers
+    } else if (opts.chunk) {
+        opts.incremental = 0;
+        if ((wt_stream = fopen(opts.files[0], "r")) == NULL) {
+            printf("File 1 not found\n");
+            return 0;
+        }
+    } else {
+        if ((watchtowers = MapWtFile(opts.files[0], opts.threads)) == NULL) {
+            printf("File 1 not found\n");
+            return 0;
+        }
+    }
+    STAT_TIME(load, phase);
+
+    // A loaded snapshot already has its splits, so only takes more from a file,
+    // and when answering queries stdin is kept for the queries.
+    int read_splits = (!opts.load_file && !opts.query) || opts.split_file;
+    // Unless -i needs the polygon before the splits, a flat DCEL is built along
+    // with its splits in one go, sized for the whole batch up front
+    int bulk = opts.flat && !opts.incremental && !opts.load_file && read_splits;
+
+    // Create DCEL with initial polygon, or map an already built one
+    phase = STAT_NOW();
+    dcel_t *DCEL = NULL;
+    flat_dcel_t *FLAT = NULL;
+    if (opts.load_file) {
+        if ((FLAT = LoadSnapshot(opts.load_file)) == NULL) {
+            printf("Snapshot not found or not readable\n");
+            return 0;
+        }
+    } else {
+        if ((file = fopen(opts.files[1], "r")) == NULL) {
+            printf("File 2 not found\n");
+            return 0;
+        }
+        if (bulk) {
+            // the polygon file stays open until the splits have been read
+        } else if (opts.flat) {
+            FLAT = CreateFlatDcel();
+            FlatFirstPolygon(FLAT, file);
+            fclose(file);
+        } else {
+            DCEL = CreateDcel();
+            FirstPolygon(DCEL, file);
+            fclose(file);
+        }
+    }
+    STAT_TIME(polygon, phase);
+
+    // With -i, group the watchtowers by face now so the splits keep the
+    // groups and populations current
+    face_wts_t *face_wts = NULL;
+    phase = STAT_NOW();
+    if (opts.incremental) {
+        face_grid_t *grid = opts.flat ? CreateFlatFaceGrid(FLAT) : CreateFaceGrid(DCEL);
+        frozen_dcel_t *frozen = opts.flat ? FreezeFlatDcel(FLAT) : FreezeDcel(DCEL);
+        face_wts = TrackFaceWts(grid, frozen, watchtowers, opts.threads);
+        if (opts.flat) {
+            FLAT->face_wts = face_wts;
+        } else {
+            DCEL->face_wts = face_wts;
+        }
+        FreeFrozenDcel(frozen);
+        FreeFaceGrid(grid);
     }
-    wt_info_t **watchtowers;
-    int watchtowers_num = 0;
-    watchtowers = ReadWtInfo(file, &watchtowers_num);
-    fclose(file);
+    STAT_TIME(track, phase);
 
-    // Create DCEL with initial polygon
-    if ((file = fopen(argv[2], "r")) == NULL) {
-        printf("File 2 not found\n");
+    // Read in and perform splits, from stdin unless a split file was given
+    phase = STAT_NOW();
+    FILE *split_file = stdin;
+    if (opts.split_file && (split_file = fopen(opts.split_file, "r")) == NULL) {
+        printf("Split file not found\n");
         return 0;
     }
-    dcel_t *DCEL;
-    DCEL = CreateDcel();
-    FirstPolygon(DCEL, file);
+    if (read_splits) {
+        double start = Seconds();
+        splits_t *splits = ReadSplits(split_file);
+        double read_end = Seconds();
+        int read_num = splits->num / 2;
+        int done;
+        if (bulk) {
+            FLAT = BuildFlatDcel(file, splits, &done);
+            fclose(file);
+        } else if (opts.flat) {
+            done = FlatApplySplits(FLAT, splits);
+        } else {
+            done = ApplySplits(DCEL, splits);
+        }
+        double split_end = Seconds();
+        FreeSplits(splits);
+        if (opts.throughput) {
+            fprintf(stderr, "Read %d splits in %.6f s, performed %d in %.6f s (%.0f splits/sec)\n",
+                read_num, read_end - start, done, split_end - read_end,
+                split_end > read_end ? done / (split_end - read_end) : 0.0);
+        }
+    }
+    if (split_file != stdin) {
+        fclose(split_file);
+    }
+    STAT_TIME(splits, phase);
 
-    // Read in and perform splits
-    int a,b;
-    while (scanf("%d %d", &a, &b) == 2) {
-        SplitFace(DCEL, a, b);
+    // Save the DCEL as split, so later runs can map it instead of rebuilding it
+    if (opts.save_file) {
+        int saved = opts.flat ? FlatSaveSnapshot(FLAT, opts.save_file) :
+            SaveSnapshot(DCEL, opts.save_file);
+        if (saved < 0) {
+            printf("Snapshot could not be written\n");
+        }
     }
-    fclose(file);
 
-    // Output and free memory
-    file = fopen(argv[3], "w");
-    CreateOutput(file, DCEL, watchtowers, watchtowers_num);
-    fclose(file);
+    // Output and free memory, or with -q or -u answer queries about the DCEL
+    // instead, until the input or the service is stopped.
+    // Unless -i already grouped the watchtowers, the DCEL is frozen into
+    // per-face edge arrays first, which every kind of output checks against.
+    phase = STAT_NOW();
+    face_grid_t *grid = NULL;
+    frozen_dcel_t *frozen = NULL;
+    if (!face_wts) {
+        grid = opts.flat ? CreateFlatFaceGrid(FLAT) : CreateFaceGrid(DCEL);
+        frozen = opts.flat ? FreezeFlatDcel(FLAT) : FreezeDcel(DCEL);
+    }
+    if (opts.batch_file) {
+        if ((file = fopen(opts.batch_file, "r")) == NULL) {
+            printf("Batch file not found\n");
+            return 0;
+        }
+        batch_t *batch = ReadBatch(file);
+        fclose(file);
+        int failed = RunBatch(batch, grid, frozen, opts.threads);
+        if (failed > 0) {
+            printf("%d of %d batch jobs failed\n", failed, batch->num);
+        }
+        FreeBatch(batch);
+    } else if (opts.query) {
+        query_service_t *qs = CreateQueryService(grid, frozen, watchtowers, opts.threads);
+        if (opts.socket_file) {
+            if (ServeSocket(qs, opts.socket_file) < 0) {
+                printf("Socket could not be served\n");
+            }
+        } else {
+            ServeQueries(qs, STDIN_FILENO, STDOUT_FILENO);
+        }
+        FreeQueryService(qs);
+    } else {
+        file = fopen(opts.files[2], "w");
+        if (face_wts) {
+            PrintFaceWts(file, face_wts, watchtowers);
+            FreeFaceWts(face_wts);
+        } else if (wt_stream) {
+            StreamOutput(file, wt_stream, grid, frozen, opts.chunk, opts.threads);
+        } else {
+            GridOutput(file, grid, frozen, watchtowers, opts.threads);
+        }
+        fclose(file);
+    }
+    if (frozen) {
+        FreeFrozenDcel(frozen);
+        FreeFaceGrid(grid);
+    }
+    STAT_TIME(output, phase);
+    if (opts.flat) {
+        FreeFlatDcel(FLAT);
+    } else {
+        FreeDcel(DCEL);
+    }
 
-    FreeDcel(DCEL);
-    FreeWts(watchtowers, &watchtowers_num);
+    if (wt_stream) {
+        fclose(wt_stream);
+    } else if (watchtowers) {
+        FreeWts(watchtowers);
+    }
+    if (StatsRequested(opts.stats)) {
+        PrintStats(stderr);
+    }
     return 0;
 
 }
-// For each face, print out the watchtowers which belong to it and 
-// add up the populations.
-void CreateOutput(FILE *file, dcel_t *dcel, wt_info_t **wts, int n) {
-
-    int w, f, passed;
-
-    // half_planes is a temporary array, half_planes[w] = 0 when
-    // the wth watchtower fails a half plane check
-    int *half_planes = (int*)malloc(sizeof(int)*n);
-
-    int *face_populations = (int*)malloc(sizeof(int)*dcel->num_face);
-
-    for (f=0;f<dcel->num_face;f++) {
 
-        // initialise possibilities
-        for (w=0;w<n;w++) {
-            half_planes[w] = 1;
-        }
-        face_populations[f] = 0;
-
-        // eliminate possibilities
-        hedge_t *hedge = dcel->face_list[f]->hedge;
-        passed = 0;
-        while (hedge != dcel->face_list[f]->hedge || !passed) {
-            passed = 1;
-            for (w=0;w<n;w++) {
-                if (!HalfPlane(dcel, hedge->v_start, hedge->v_end,
-                    wts[w]->x, wts[w]->y)) {
-                        half_planes[w] = 0;
-                    }
+// Separates options from file names, and returns the number of file names
+int ParseOptions(int argc, char **argv, options_t *opts) {
+    int i, n = 0;
+    opts->flat = 0;
+    opts->threads = 1;
+    opts->split_file = NULL;
+    opts->throughput = 0;
+    opts->incremental = 0;
+    opts->save_file = NULL;
+    opts->load_file = NULL;
+    opts->chunk = 0;
+    opts->stats = 0;
+    opts->query = 0;
+    opts->socket_file = NULL;
+    opts->batch_file = NULL;
+    opts->files[0] = opts->files[1] = opts->files[2] = NULL;
+    for (i=1;i<argc;i++) {
+        if (strcmp(argv[i], "-f") == 0) {
+            opts->flat = 1;
+        } else if (strcmp(argv[i], "-s") == 0 && i+1 < argc) {
+            opts->split_file = argv[++i];
+        } else if (strcmp(argv[i], "-i") == 0) {
+            opts->incremental = 1;
+        } else if (strcmp(argv[i], "-w") == 0 && i+1 < argc) {
+            opts->save_file = argv[++i];
+        } else if (strcmp(argv[i], "-l") == 0 && i+1 < argc) {
+            opts->load_file = argv[++i];
+        } else if (strcmp(argv[i], "-c") == 0 && i+1 < argc) {
+            opts->chunk = atoi(argv[++i]);
+            if (opts->chunk < 0) {
+                opts->chunk = 0;
             }
-            hedge = hedge->next;
-        }
-        
-        // sum remaining possibilities
-        fprintf(file, "%d\n", f);
-        for (w=0;w<n;w++) {
-            if (half_planes[w]) {
-                PrintWtInfo(file, wts[w]);
-                face_populations[f] += wts[w]->population;
+        } else if (strcmp(argv[i], "-q") == 0) {
+            opts->query = 1;
+        } else if (strcmp(argv[i], "-u") == 0 && i+1 < argc) {
+            opts->query = 1;
+            opts->socket_file = argv[++i];
+        } else if (strcmp(argv[i], "-b") == 0 && i+1 < argc) {
+            opts->batch_file = argv[++i];
+        } else if (strcmp(argv[i], "--stats") == 0) {
+            opts->stats = 1;
+        } else if (strcmp(argv[i], "-t") == 0) {
+            opts->throughput = 1;
+        } else if (strcmp(argv[i], "-j") == 0 && i+1 < argc) {
+            opts->threads = atoi(argv[++i]);
+            if (opts->threads < 1) {
+                opts->threads = 1;
             }
+        } else if (n < 3) {
+            opts->files[n++] = argv[i];
         }
     }
+    return n;
+}
 
-    // Print populations and free temporary arrays
-    for (f=0;f<dcel->num_face;f++) {
-        fprintf(file, "Face %d population served: %d\n", f, face_populations[f]);
-    }
-    free(half_planes);
-    free(face_populations);
-
+// Returns a monotonic time in seconds, for timing phases
+double Seconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
 }
\ No newline at end of file
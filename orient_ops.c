@@ -0,0 +1,228 @@
+// orient_ops.c
+// Exact orientation of a point relative to a directed line
+
+// Orient2d gives the sign of
+//     (Px - Ax)*(By - Ay) - (Bx - Ax)*(Py - Ay)
+// computed exactly, so 1 means P is strictly in the half plane of A-->B
+// (the side HalfPlane accepts), -1 strictly in the other one, and 0 that
+// P lies on the line through A and B.
+// The determinant is first computed in plain doubles, and that answer is
+// used whenever it is larger than its worst case rounding error, which is
+// almost always. Otherwise it is refined in stages with exact floating point
+// expansions, following Shewchuk's adaptive orient2d from "Adaptive Precision
+// Floating-Point Arithmetic and Fast Robust Geometric Predicates" (1997).
+// Needs plain IEEE double arithmetic: no x87 extended precision and no fused
+// multiply-add contraction of the expressions below.
+
+#include <math.h>
+#include "orient_ops.h"
+#include "stats_ops.h"
+
+// 2^27 + 1, splits a double into two halves of 26 bits
+#define SPLITTER 134217729.0
+#define RESULT_ERRBOUND ((3.0 + 8.0 * ORIENT_EPSILON) * ORIENT_EPSILON)
+#define ORIENT_ERRBOUND_B ((2.0 + 12.0 * ORIENT_EPSILON) * ORIENT_EPSILON)
+#define ORIENT_ERRBOUND_C ((9.0 + 64.0 * ORIENT_EPSILON) * ORIENT_EPSILON * ORIENT_EPSILON)
+
+//==============================================================================
+// Error-free transformations. Each gives x, the rounded result, and y, the
+// rounding error, so that x + y is exactly the true result.
+//==============================================================================
+
+static void TwoSum(double a, double b, double *x, double *y) {
+    double s = a + b;
+    double bv = s - a;
+    double av = s - bv;
+    *x = s;
+    *y = (a - av) + (b - bv);
+}
+
+static void TwoDiffTail(double a, double b, double x, double *y) {
+    double bv = a - x;
+    double av = x + bv;
+    *y = (a - av) + (bv - b);
+}
+
+static void TwoDiff(double a, double b, double *x, double *y) {
+    *x = a - b;
+    TwoDiffTail(a, b, *x, y);
+}
+
+static void Split(double a, double *hi, double *lo) {
+    double c = SPLITTER * a;
+    double big = c - a;
+    *hi = c - big;
+    *lo = a - *hi;
+}
+
+static void TwoProduct(double a, double b, double *x, double *y) {
+    double ahi, alo, bhi, blo;
+    double p = a * b;
+    Split(a, &ahi, &alo);
+    Split(b, &bhi, &blo);
+    double err = ((p - ahi*bhi) - alo*bhi) - ahi*blo;
+    *x = p;
+    *y = alo*blo - err;
+}
+
+// (a1 + a0) - (b1 + b0) as a 4 component expansion, smallest first
+static void TwoTwoDiff(double a1, double a0, double b1, double b0, double *x) {
+    double i, j, k;
+    TwoDiff(a0, b0, &i, &x[0]);
+    TwoSum(a1, i, &j, &k);
+    TwoDiff(k, b1, &i, &x[1]);
+    TwoSum(j, i, &x[3], &x[2]);
+}
+
+// Sums two expansions into h, dropping zero components, and returns the
+// length of h. Shewchuk's fast_expansion_sum_zeroelim.
+static int ExpansionSum(int elen, const double *e, int flen, const double *f, double *h) {
+    double Q, Qnew, hh, enow = e[0], fnow = f[0];
+    int ei = 0, fi = 0, hi = 0;
+    if ((fnow > enow) == (fnow > -enow)) {
+        Q = enow;
+        if (++ei < elen) enow = e[ei];
+    } else {
+        Q = fnow;
+        if (++fi < flen) fnow = f[fi];
+    }
+    if (ei < elen && fi < flen) {
+        if ((fnow > enow) == (fnow > -enow)) {
+            Qnew = enow + Q;
+            hh = Q - (Qnew - enow);
+            if (++ei < elen) enow = e[ei];
+        } else {
+            Qnew = fnow + Q;
+            hh = Q - (Qnew - fnow);
+            if (++fi < flen) fnow = f[fi];
+        }
+        Q = Qnew;
+        if (hh != 0.0) {
+            h[hi++] = hh;
+        }
+        while (ei < elen && fi < flen) {
+            if ((fnow > enow) == (fnow > -enow)) {
+                TwoSum(Q, enow, &Qnew, &hh);
+                if (++ei < elen) enow = e[ei];
+            } else {
+                TwoSum(Q, fnow, &Qnew, &hh);
+                if (++fi < flen) fnow = f[fi];
+            }
+            Q = Qnew;
+            if (hh != 0.0) {
+                h[hi++] = hh;
+            }
+        }
+    }
+    while (ei < elen) {
+        TwoSum(Q, enow, &Qnew, &hh);
+        if (++ei < elen) enow = e[ei];
+        Q = Qnew;
+        if (hh != 0.0) {
+            h[hi++] = hh;
+        }
+    }
+    while (fi < flen) {
+        TwoSum(Q, fnow, &Qnew, &hh);
+        if (++fi < flen) fnow = f[fi];
+        Q = Qnew;
+        if (hh != 0.0) {
+            h[hi++] = hh;
+        }
+    }
+    if (Q != 0.0 || hi == 0) {
+        h[hi++] = Q;
+    }
+    return hi;
+}
+
+static int Sign(double v) {
+    return (v > 0) - (v < 0);
+}
+
+//==============================================================================
+// The exact stages, for when the plain double determinant is too close to 0.
+// detsum is |left| + |right| of the plain determinant.
+//==============================================================================
+static int Orient2dAdapt(double Ax, double Ay, double Bx, double By,
+    double Px, double Py, double detsum) {
+    STAT_ADD_SHARED(orient_exact, 1);
+    double pax = Px - Ax, bax = Bx - Ax;
+    double pay = Py - Ay, bay = By - Ay;
+    double left, left_tail, right, right_tail;
+    double B[4], u[4], C1[8], C2[12], D[16];
+
+    TwoProduct(pax, bay, &left, &left_tail);
+    TwoProduct(pay, bax, &right, &right_tail);
+    TwoTwoDiff(left, left_tail, right, right_tail, B);
+    double det = B[0] + B[1] + B[2] + B[3];
+    double errbound = ORIENT_ERRBOUND_B * detsum;
+    if (det >= errbound || -det >= errbound) {
+        return Sign(det);
+    }
+
+    // the differences themselves were rounded
+    double pax_tail, bax_tail, pay_tail, bay_tail;
+    TwoDiffTail(Px, Ax, pax, &pax_tail);
+    TwoDiffTail(Bx, Ax, bax, &bax_tail);
+    TwoDiffTail(Py, Ay, pay, &pay_tail);
+    TwoDiffTail(By, Ay, bay, &bay_tail);
+    if (pax_tail == 0.0 && pay_tail == 0.0 && bax_tail == 0.0 && bay_tail == 0.0) {
+        return Sign(det);
+    }
+
+    errbound = ORIENT_ERRBOUND_C * detsum + RESULT_ERRBOUND * fabs(det);
+    det += (pax * bay_tail + bay * pax_tail) - (pay * bax_tail + bax * pay_tail);
+    if (det >= errbound || -det >= errbound) {
+        return Sign(det);
+    }
+
+    double s1, s0, t1, t0;
+    TwoProduct(pax_tail, bay, &s1, &s0);
+    TwoProduct(pay_tail, bax, &t1, &t0);
+    TwoTwoDiff(s1, s0, t1, t0, u);
+    int c1_len = ExpansionSum(4, B, 4, u, C1);
+
+    TwoProduct(pax, bay_tail, &s1, &s0);
+    TwoProduct(pay, bax_tail, &t1, &t0);
+    TwoTwoDiff(s1, s0, t1, t0, u);
+    int c2_len = ExpansionSum(c1_len, C1, 4, u, C2);
+
+    TwoProduct(pax_tail, bay_tail, &s1, &s0);
+    TwoProduct(pay_tail, bax_tail, &t1, &t0);
+    TwoTwoDiff(s1, s0, t1, t0, u);
+    int d_len = ExpansionSum(c2_len, C2, 4, u, D);
+
+    // the largest component of an expansion decides its sign
+    return Sign(D[d_len - 1]);
+}
+
+// Returns 1 if P is strictly in the half plane of A-->B, -1 if it is
+// strictly in the other half plane, and 0 if it lies on the line AB
+int Orient2d(double Ax, double Ay, double Bx, double By, double Px, double Py) {
+    double left = (Px - Ax)*(By - Ay);
+    double right = (Bx - Ax)*(Py - Ay);
+    double det = left - right;
+    double detsum;
+
+    // if the two products differ in sign, the sign of det is certain
+    if (left > 0) {
+        if (right <= 0) {
+            return Sign(det);
+        }
+        detsum = left + right;
+    } else if (left < 0) {
+        if (right >= 0) {
+            return Sign(det);
+        }
+        detsum = -left - right;
+    } else {
+        return Sign(det);
+    }
+
+    double errbound = ORIENT_ERRBOUND_A * detsum;
+    if (det >= errbound || -det >= errbound) {
+        return Sign(det);
+    }
+    return Orient2dAdapt(Ax, Ay, Bx, By, Px, Py, detsum);
+}
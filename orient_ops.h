@@ -0,0 +1,11 @@
+#ifndef ORIENT_OPS_H
+#define ORIENT_OPS_H
+
+// Relative error bound of the plain double determinant, for filters which
+// compute it themselves and call Orient2d only when it cannot be trusted
+#define ORIENT_ERRBOUND_A ((3.0 + 16.0 * ORIENT_EPSILON) * ORIENT_EPSILON)
+#define ORIENT_EPSILON 1.1102230246251565e-16
+
+int Orient2d(double Ax, double Ay, double Bx, double By, double Px, double Py);
+
+#endif
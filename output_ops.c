@@ -0,0 +1,128 @@
+// output_ops.c
+// Creates the desired output
+
+// Handles the following:
+// - Classifying the watchtowers against either DCEL layout and printing
+//       each face's watchtowers and population
+// - Grouping the watchtowers by face for a DCEL to keep up to date,
+//       and printing from those groups
+// - Writing the output through one buffered writer
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "output_ops.h"
+
+// For each face, print out the watchtowers which belong to it and 
+// add up the populations.
+// Each watchtower is located through a grid over the faces, so it is only
+// tested against the faces near it rather than every face, and the faces are
+// frozen into flat edge arrays first.
+void CreateOutput(FILE *file, dcel_t *dcel, wt_table_t *wts, int threads) {
+    face_grid_t *grid = CreateFaceGrid(dcel);
+    frozen_dcel_t *frozen = FreezeDcel(dcel);
+    GridOutput(file, grid, frozen, wts, threads);
+    FreeFrozenDcel(frozen);
+    FreeFaceGrid(grid);
+}
+
+// Same as CreateOutput, through a grid already built over the faces of a
+// frozen DCEL. Neither is changed, so several outputs may be created from
+// them at once.
+void GridOutput(FILE *file, face_grid_t *grid, frozen_dcel_t *frozen,
+    wt_table_t *wts, int threads) {
+    matches_t matches = {0, 0, NULL, NULL};
+    ClassifyWts(grid, frozen, wts, threads, &matches);
+    SortMatches(&matches, wts->n, frozen->num_face);
+    PrintFaces(file, frozen->num_face, &matches, wts);
+}
+
+// Classifies the watchtowers against the DCEL as it is now, frozen, and
+// returns them grouped by face for the DCEL to keep up to date
+face_wts_t *TrackFaceWts(face_grid_t *grid, frozen_dcel_t *frozen,
+    wt_table_t *wts, int threads) {
+    int num_face = frozen->num_face;
+    matches_t matches = {0, 0, NULL, NULL};
+    ClassifyWts(grid, frozen, wts, threads, &matches);
+    SortMatches(&matches, wts->n, num_face);
+    face_wts_t *fw = CreateFaceWts(wts, num_face, frozen->convex,
+        matches.face, matches.wt, matches.num);
+    free(matches.face);
+    free(matches.wt);
+    return fw;
+}
+
+// Same as CreateOutput, on the flat layout
+void FlatCreateOutput(FILE *file, flat_dcel_t *dcel, wt_table_t *wts, int threads) {
+    face_grid_t *grid = CreateFlatFaceGrid(dcel);
+    frozen_dcel_t *frozen = FreezeFlatDcel(dcel);
+    GridOutput(file, grid, frozen, wts, threads);
+    FreeFrozenDcel(frozen);
+    FreeFaceGrid(grid);
+}
+
+// The line starting face f's watchtowers
+void WriteFaceHeader(writer_t *writer, int f) {
+    WriteInt(writer, f);
+    WriteBytes(writer, "\n", 1);
+}
+
+// The line giving face f's population
+void WriteFacePopulation(writer_t *writer, int f, int population) {
+    WriteString(writer, "Face ");
+    WriteInt(writer, f);
+    WriteString(writer, " population served: ");
+    WriteInt(writer, population);
+    WriteBytes(writer, "\n", 1);
+}
+
+// Prints each face's watchtowers followed by the face populations.
+// The matches must already be sorted by SortMatches, and are freed afterwards.
+void PrintFaces(FILE *file, int num_face, matches_t *matches, wt_table_t *wts) {
+
+    int f, k = 0;
+    int *face_populations;
+    if ( (face_populations = (int*)malloc(sizeof(int)*(num_face+1))) == NULL ) {
+        printf("malloc() error\n");
+        exit(EXIT_FAILURE);
+    }
+    writer_t *writer = CreateWriter(file);
+
+    // print each face's watchtowers and sum the populations
+    for (f=0;f<num_face;f++) {
+        face_populations[f] = 0;
+        WriteFaceHeader(writer, f);
+        for (;k<matches->num && matches->face[k] == f;k++) {
+            WriteWtInfo(writer, wts, matches->wt[k]);
+            face_populations[f] += wts->population[matches->wt[k]];
+        }
+    }
+
+    // Print populations and free temporary arrays
+    for (f=0;f<num_face;f++) {
+        WriteFacePopulation(writer, f, face_populations[f]);
+    }
+    FreeWriter(writer);
+    free(face_populations);
+    free(matches->face);
+    free(matches->wt);
+
+}
+
+// Prints the same output as PrintFaces, from the watchtower groups kept
+// up to date during the splits, so no classification is needed
+void PrintFaceWts(FILE *file, face_wts_t *fw, wt_table_t *wts) {
+
+    int f, k;
+    writer_t *writer = CreateWriter(file);
+    for (f=0;f<fw->num_face;f++) {
+        WriteFaceHeader(writer, f);
+        for (k=0;k<fw->count[f];k++) {
+            WriteWtInfo(writer, wts, fw->members[f][k]);
+        }
+    }
+    for (f=0;f<fw->num_face;f++) {
+        WriteFacePopulation(writer, f, FacePopulation(fw, f));
+    }
+    FreeWriter(writer);
+
+}
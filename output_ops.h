@@ -0,0 +1,32 @@
+#ifndef OUTPUT_OPS_H
+#define OUTPUT_OPS_H
+
+#include <stdio.h>
+#include "wt_ops.h"
+#include "dcel_ops.h"
+#include "flat_ops.h"
+#include "locate_ops.h"
+#include "classify_ops.h"
+#include "frozen_ops.h"
+#include "pop_ops.h"
+#include "writer_ops.h"
+
+void CreateOutput(FILE *file, dcel_t *dcel, wt_table_t *wts, int threads);
+
+void FlatCreateOutput(FILE *file, flat_dcel_t *dcel, wt_table_t *wts, int threads);
+
+void GridOutput(FILE *file, face_grid_t *grid, frozen_dcel_t *frozen,
+    wt_table_t *wts, int threads);
+
+face_wts_t *TrackFaceWts(face_grid_t *grid, frozen_dcel_t *frozen,
+    wt_table_t *wts, int threads);
+
+void PrintFaces(FILE *file, int num_face, matches_t *matches, wt_table_t *wts);
+
+void PrintFaceWts(FILE *file, face_wts_t *fw, wt_table_t *wts);
+
+void WriteFaceHeader(writer_t *writer, int f);
+
+void WriteFacePopulation(writer_t *writer, int f, int population);
+
+#endif
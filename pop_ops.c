@@ -0,0 +1,249 @@
+// pop_ops.c
+// Face populations maintained through splits
+
+// Handles the following:
+// - Grouping watchtowers by face once, from an initial classification
+// - Repartitioning one face's watchtowers when that face is split, by the
+//       split's line if the face is convex, otherwise by winding number
+//       around the new face
+// - Renumbering the groups along with the DCEL's faces
+// - Looking up a face's population
+// - Freeing the groups
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "pop_ops.h"
+#include "orient_ops.h"
+#include "stats_ops.h"
+
+#define F_START_SIZE 4
+
+// Makes room for face f
+static void GrowFaces(face_wts_t *fw, int f) {
+    if (f < fw->size_face) {
+        return;
+    }
+    if (fw->size_face == 0) {
+        fw->size_face = F_START_SIZE;
+    }
+    while (f >= fw->size_face) {
+        fw->size_face*=2;
+    }
+    if ( (fw->members = (int**)realloc(fw->members, sizeof(int*)*fw->size_face)) == NULL ||
+         (fw->count = (int*)realloc(fw->count, sizeof(int)*fw->size_face)) == NULL ||
+         (fw->population = (int*)realloc(fw->population, sizeof(int)*fw->size_face)) == NULL ||
+         (fw->convex = (unsigned char*)realloc(fw->convex, fw->size_face)) == NULL ) {
+        printf("realloc() error\n");
+        exit(EXIT_FAILURE);
+    }
+}
+
+// Returns pointer to the watchtowers grouped by face, given which faces are
+// convex and every (face, watchtower) pair where the watchtower lies in the
+// face. The pairs must be in watchtower order within each face.
+face_wts_t *CreateFaceWts(wt_table_t *wts, int num_face, unsigned char *convex,
+    int *match_face, int *match_wt, int num_match) {
+    face_wts_t *fw;
+    if ( (fw = (face_wts_t*)malloc(sizeof(face_wts_t))) == NULL ) {
+        printf("malloc() error\n");
+        exit(EXIT_FAILURE);
+    }
+    fw->num_face = num_face;
+    fw->size_face = 0;
+    fw->members = NULL;
+    fw->count = NULL;
+    fw->population = NULL;
+    fw->convex = NULL;
+    GrowFaces(fw, num_face);
+
+    fw->n = wts->n;
+    fw->xs = wts->x;
+    fw->ys = wts->y;
+    fw->wt_population = wts->population;
+    int i, f;
+
+    for (f=0;f<num_face;f++) {
+        fw->count[f] = 0;
+        fw->population[f] = 0;
+        fw->convex[f] = convex[f];
+    }
+    for (i=0;i<num_match;i++) {
+        fw->count[match_face[i]]++;
+    }
+    for (f=0;f<num_face;f++) {
+        if ( (fw->members[f] = (int*)malloc(sizeof(int)*(fw->count[f]+1))) == NULL ) {
+            printf("malloc() error\n");
+            exit(EXIT_FAILURE);
+        }
+        fw->count[f] = 0;
+    }
+    for (i=0;i<num_match;i++) {
+        f = match_face[i];
+        fw->members[f][fw->count[f]++] = match_wt[i];
+        fw->population[f] += fw->wt_population[match_wt[i]];
+    }
+    return fw;
+}
+
+// Returns 1 if splitting face f needs the new face's ring, because f is not
+// known to be convex and has watchtowers to repartition
+int FaceWtsNeedRing(face_wts_t *fw, int f) {
+    return !fw->convex[f] && fw->count[f] > 0;
+}
+
+// Returns 1 if (x, y) is strictly inside the ring of n vertices, given as
+// x, y pairs, 0 if it is on the ring and -1 if it is outside. Counted by
+// winding number, as frozen faces which are not convex are checked.
+static int RingSide(double *ring, int n, double x, double y) {
+    int i, winding = 0, checked = 0;
+    for (i=0;i<n;i++) {
+        double Ax = ring[2*i], Ay = ring[2*i+1];
+        double Bx = ring[2*((i+1)%n)], By = ring[2*((i+1)%n)+1];
+        if ((y < Ay && y < By) || (y > Ay && y > By)) {
+            continue;
+        }
+        checked++;
+        int side = Orient2d(Ax, Ay, Bx, By, x, y);
+        if (side == 0 && x >= fmin(Ax, Bx) && x <= fmax(Ax, Bx)) {
+            STAT_ADD(crossing_edges, checked);
+            return 0;
+        }
+        if (Ay <= y) {
+            if (By > y && side < 0) {
+                winding++;
+            }
+        } else if (By <= y && side > 0) {
+            winding--;
+        }
+    }
+    STAT_ADD(crossing_edges, checked);
+    return winding != 0 ? 1 : -1;
+}
+
+// Returns 1 if the ring of n vertices never turns away from the side its
+// half planes keep, as for a convex frozen face
+static int RingConvex(double *ring, int n) {
+    int i;
+    for (i=0;i<n;i++) {
+        int prev = (i+n-1)%n, next = (i+1)%n;
+        if (Orient2d(ring[2*prev], ring[2*prev+1], ring[2*i], ring[2*i+1],
+            ring[2*next], ring[2*next+1]) < 0) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+//==============================================================================
+// Called when face_old has just been split along M-->N, where the half-edge
+// M-->N stays in face_old and N-->M is in face_new.
+// Only face_old's watchtowers are looked at. If face_old was convex, those in
+// the half plane of M-->N stay, those in the half plane of N-->M move to
+// face_new, and any lying on the line itself are in neither face.
+// Otherwise the line may cross face_old elsewhere too, so ring must hold
+// face_new's ring_n vertices, as x, y pairs in ring order, whenever
+// FaceWtsNeedRing says so. Those strictly inside it move, those on it are in
+// neither face and the rest stay. Both faces keep input order.
+//==============================================================================
+void SplitFaceWts(face_wts_t *fw, int face_old, int face_new,
+    double Mx, double My, double Nx, double Ny, double *ring, int ring_n) {
+    GrowFaces(fw, face_new);
+    while (fw->num_face <= face_new) {
+        fw->members[fw->num_face] = NULL;
+        fw->count[fw->num_face] = 0;
+        fw->population[fw->num_face] = 0;
+        fw->convex[fw->num_face] = 0;
+        fw->num_face++;
+    }
+
+    int *old = fw->members[face_old];
+    int n = fw->count[face_old];
+    int *moved;
+    if ( (moved = (int*)malloc(sizeof(int)*(n+1))) == NULL ) {
+        printf("malloc() error\n");
+        exit(EXIT_FAILURE);
+    }
+    int i, kept = 0, num_moved = 0;
+    int kept_pop = 0, moved_pop = 0;
+    int convex = fw->convex[face_old];
+    if (convex) {
+        STAT_ADD(half_plane, n);
+    }
+    for (i=0;i<n;i++) {
+        int w = old[i];
+        int side;
+        if (convex) {
+            // same test as HalfPlane, one exact sign covers both M-->N and N-->M
+            side = Orient2d(Mx, My, Nx, Ny, fw->xs[w], fw->ys[w]);
+        } else {
+            // inside face_new counts as the N-->M side
+            side = -RingSide(ring, ring_n, fw->xs[w], fw->ys[w]);
+        }
+        if (side > 0) {
+            old[kept++] = w;
+            kept_pop += fw->wt_population[w];
+        } else if (side < 0) {
+            moved[num_moved++] = w;
+            moved_pop += fw->wt_population[w];
+        }
+    }
+
+    fw->count[face_old] = kept;
+    fw->population[face_old] = kept_pop;
+    free(fw->members[face_new]);
+    fw->members[face_new] = moved;
+    fw->count[face_new] = num_moved;
+    fw->population[face_new] = moved_pop;
+    // both sides of a convex face are convex, and the new face of any other
+    // is checked while its ring is to hand
+    fw->convex[face_new] = convex || (ring && RingConvex(ring, ring_n));
+}
+
+// Moves the group of every face f to face order[f], as RenumberFaces does
+// with the faces themselves
+void RenumberFaceWts(face_wts_t *fw, int *order) {
+    int f, n = fw->num_face;
+    int **members;
+    int *count, *population;
+    unsigned char *convex;
+    if ( (members = (int**)malloc(sizeof(int*)*fw->size_face)) == NULL ||
+         (count = (int*)malloc(sizeof(int)*fw->size_face)) == NULL ||
+         (population = (int*)malloc(sizeof(int)*fw->size_face)) == NULL ||
+         (convex = (unsigned char*)malloc(fw->size_face)) == NULL ) {
+        printf("malloc() error\n");
+        exit(EXIT_FAILURE);
+    }
+    for (f=0;f<n;f++) {
+        members[order[f]] = fw->members[f];
+        count[order[f]] = fw->count[f];
+        population[order[f]] = fw->population[f];
+        convex[order[f]] = fw->convex[f];
+    }
+    free(fw->members);
+    free(fw->count);
+    free(fw->population);
+    free(fw->convex);
+    fw->members = members;
+    fw->count = count;
+    fw->population = population;
+    fw->convex = convex;
+}
+
+// Returns the total population of the watchtowers in face f
+int FacePopulation(face_wts_t *fw, int f) {
+    return fw->population[f];
+}
+
+void FreeFaceWts(face_wts_t *fw) {
+    int f;
+    for (f=0;f<fw->num_face;f++) {
+        free(fw->members[f]);
+    }
+    free(fw->members);
+    free(fw->count);
+    free(fw->population);
+    free(fw->convex);
+    free(fw);
+}
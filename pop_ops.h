@@ -0,0 +1,42 @@
+#ifndef POP_OPS_H
+#define POP_OPS_H
+
+#include "wt_ops.h"
+
+// Watchtowers kept grouped by the face they lie in, with each face's
+// population summed, so that both stay current as faces are split.
+// Each face's watchtowers are kept in input order.
+typedef struct face_wts face_wts_t;
+
+struct face_wts {
+    int num_face;
+    int size_face;
+    int **members;
+    int *count;
+    int *population;
+    // 1 for each face known to be convex, which a split's line is enough
+    // to repartition
+    unsigned char *convex;
+    // coordinates and populations of every watchtower, the columns of the
+    // watchtower table, which must outlive the groups
+    int n;
+    double *xs;
+    double *ys;
+    int *wt_population;
+};
+
+face_wts_t *CreateFaceWts(wt_table_t *wts, int num_face, unsigned char *convex,
+    int *match_face, int *match_wt, int num_match);
+
+int FaceWtsNeedRing(face_wts_t *fw, int f);
+
+void SplitFaceWts(face_wts_t *fw, int face_old, int face_new,
+    double Mx, double My, double Nx, double Ny, double *ring, int ring_n);
+
+void RenumberFaceWts(face_wts_t *fw, int *order);
+
+int FacePopulation(face_wts_t *fw, int f);
+
+void FreeFaceWts(face_wts_t *fw);
+
+#endif
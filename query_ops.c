@@ -0,0 +1,357 @@
+// query_ops.c
+// Answers point location and population queries about a built DCEL
+
+// Handles the following:
+// - Working out every face's population once, before any query
+// - Finding the face containing a point through the face grid
+// - Reading queries from a file descriptor, answering everything received
+//       so far before writing the replies back in one go
+// - Serving queries over a Unix socket, one thread per connection
+//
+// Queries are one per line, and each is answered by one line:
+//     F x y    index of the face containing (x, y), or -1 if none does
+//     P f      population of face f, or -1 if there is no face f
+//     N        number of faces
+//     B        bounding box of the polygon, as min x, min y, max x, max y
+// Anything else is answered by a line starting with ERR, as is an F or P
+// whose arguments are not wholly numbers, or a face index beyond an int.
+// Clients may send many queries before reading any replies, and replies
+// always come back in the order the queries were sent.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <signal.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "query_ops.h"
+
+// Bytes of queries read at a time, also the longest query accepted
+#define QUERY_BUF_SIZE (1 << 16)
+// Replies are written out once this many bytes are waiting
+#define REPLY_BUF_SIZE (1 << 16)
+// Longest single reply, the bounding box line
+#define MAX_REPLY_LEN 128
+// Fields up to this long are parsed without a malloc
+#define MAX_FIELD_LEN 64
+
+// A connection handed to its own thread
+typedef struct {
+    query_service_t *qs;
+    int fd;
+} connection_t;
+
+//==============================================================================
+// Returns pointer to a query service over a frozen DCEL. Every watchtower is
+// classified once, so population queries are only a lookup. The grid and
+// frozen DCEL are not owned by the service.
+//==============================================================================
+query_service_t *CreateQueryService(face_grid_t *grid, frozen_dcel_t *frozen,
+    wt_table_t *wts, int threads) {
+    int num_face = frozen->num_face;
+    query_service_t *qs;
+    if ( (qs = (query_service_t*)malloc(sizeof(query_service_t))) == NULL ||
+         (qs->population = (int*)calloc(num_face+1, sizeof(int))) == NULL ) {
+        printf("malloc() error\n");
+        exit(EXIT_FAILURE);
+    }
+    qs->grid = grid;
+    qs->frozen = frozen;
+    qs->num_face = num_face;
+
+    matches_t matches = {0, 0, NULL, NULL};
+    ClassifyWts(grid, frozen, wts, threads, &matches);
+    int k;
+    for (k=0;k<matches.num;k++) {
+        qs->population[matches.face[k]] += wts->population[matches.wt[k]];
+    }
+    free(matches.face);
+    free(matches.wt);
+    return qs;
+}
+
+// Returns the lowest indexed face containing (x, y), or -1 if there is none
+int QueryFace(query_service_t *qs, double x, double y) {
+    return FrozenLocateFace(qs->grid, qs->frozen, x, y);
+}
+
+// Returns the population of face f, or -1 if there is no face f
+int QueryPopulation(query_service_t *qs, int f) {
+    if (f < 0 || f >= qs->num_face) {
+        return -1;
+    }
+    return qs->population[f];
+}
+
+//==============================================================================
+// Reading and answering queries
+//==============================================================================
+
+// Returns the start of the next field of [*p, end) and moves *p to its end,
+// or returns NULL if there are no more fields
+static char *NextField(char **p, char *end) {
+    char *s = *p;
+    while (s < end && (*s == ' ' || *s == '\t' || *s == '\r')) {
+        s++;
+    }
+    if (s == end) {
+        return NULL;
+    }
+    char *e = s;
+    while (e < end && *e != ' ' && *e != '\t' && *e != '\r') {
+        e++;
+    }
+    *p = e;
+    return s;
+}
+
+// Calls strtod or strtol on a terminated copy of the field [s, end), which
+// is at most a query long, and returns 1 if the whole field was the number
+static int ParseField(char *s, char *end, double *d, long *l) {
+    char buf[MAX_FIELD_LEN];
+    size_t len = end - s;
+    char *copy = len < MAX_FIELD_LEN ? buf : (char*)malloc(len+1);
+    if (copy == NULL) {
+        printf("malloc() error\n");
+        exit(EXIT_FAILURE);
+    }
+    memcpy(copy, s, len);
+    copy[len] = '\0';
+    char *stop;
+    errno = 0;
+    if (d) {
+        *d = strtod(copy, &stop);
+    } else {
+        *l = strtol(copy, &stop, 10);
+    }
+    int whole = stop == copy + len && errno != ERANGE;
+    if (copy != buf) {
+        free(copy);
+    }
+    return whole;
+}
+
+// Parses the field [s, end) as a double into *v, returns 0 if any of the
+// field is left over or the number is out of range
+static int FieldDouble(char *s, char *end, double *v) {
+    return ParseField(s, end, v, NULL);
+}
+
+// Parses the field [s, end) as an int into *v, returns 0 if any of the
+// field is left over or the number does not fit in an int
+static int FieldInt(char *s, char *end, int *v) {
+    long l;
+    if (!ParseField(s, end, NULL, &l) || l < INT_MIN || l > INT_MAX) {
+        return 0;
+    }
+    *v = (int)l;
+    return 1;
+}
+
+// Writes the query on [line, end) to out and returns the reply's length,
+// or -1 for a blank line, which is not a query and gets no reply
+static int Answer(query_service_t *qs, char *line, char *end, char *out) {
+    char *p = line;
+    char *cmd = NextField(&p, end);
+    if (cmd == NULL) {
+        return -1;
+    }
+    int cmd_len = p - cmd;
+    char *a = NextField(&p, end);
+    char *a_end = p;
+    char *b = a ? NextField(&p, end) : NULL;
+    char *b_end = p;
+    int len;
+    double x, y;
+    int f;
+    if (cmd_len == 1 && *cmd == 'F' && b) {
+        if (FieldDouble(a, a_end, &x) && FieldDouble(b, b_end, &y)) {
+            len = FormatInt(out, QueryFace(qs, x, y));
+        } else {
+            len = snprintf(out, MAX_REPLY_LEN, "ERR bad argument");
+        }
+    } else if (cmd_len == 1 && *cmd == 'P' && a) {
+        if (FieldInt(a, a_end, &f)) {
+            len = FormatInt(out, QueryPopulation(qs, f));
+        } else {
+            len = snprintf(out, MAX_REPLY_LEN, "ERR bad argument");
+        }
+    } else if (cmd_len == 1 && *cmd == 'N') {
+        len = FormatInt(out, qs->num_face);
+    } else if (cmd_len == 1 && *cmd == 'B') {
+        len = snprintf(out, MAX_REPLY_LEN, "%.17g %.17g %.17g %.17g",
+            qs->grid->min_x, qs->grid->min_y, qs->grid->max_x, qs->grid->max_y);
+    } else {
+        len = snprintf(out, MAX_REPLY_LEN, "ERR unknown query");
+    }
+    out[len++] = '\n';
+    return len;
+}
+
+// Writes all len bytes of buf to fd, returns 0 on success and -1 on failure
+static int WriteAll(int fd, char *buf, size_t len) {
+    while (len > 0) {
+        ssize_t done = write(fd, buf, len);
+        if (done < 0 && errno == EINTR) {
+            continue;
+        }
+        if (done <= 0) {
+            return -1;
+        }
+        buf += done;
+        len -= done;
+    }
+    return 0;
+}
+
+//==============================================================================
+// Answers queries read from in_fd until it is closed, writing the replies to
+// out_fd. Each read may bring many queries, which are all answered before
+// their replies are written together, so a client sending queries in batches
+// costs one read and one write per batch rather than per query.
+// Returns the number of queries answered.
+//==============================================================================
+int ServeQueries(query_service_t *qs, int in_fd, int out_fd) {
+    char *buf = (char*)malloc(QUERY_BUF_SIZE);
+    char *reply = (char*)malloc(REPLY_BUF_SIZE + MAX_REPLY_LEN);
+    if (buf == NULL || reply == NULL) {
+        printf("malloc() error\n");
+        exit(EXIT_FAILURE);
+    }
+    size_t len = 0, reply_len = 0;
+    int answered = 0, failed = 0;
+    // set while skipping the rest of a line too long for the buffer
+    int skipping = 0;
+    while (!failed) {
+        ssize_t got = read(in_fd, buf + len, QUERY_BUF_SIZE - len);
+        if (got < 0 && errno == EINTR) {
+            continue;
+        }
+        if (got <= 0) {
+            break;
+        }
+        len += got;
+
+        // answer every complete line
+        char *p = buf;
+        char *end = buf + len;
+        char *nl;
+        while ((nl = (char*)memchr(p, '\n', end - p)) != NULL) {
+            int n = skipping ? -1 : Answer(qs, p, nl, reply + reply_len);
+            if (skipping) {
+                skipping = 0;
+            }
+            if (n >= 0) {
+                reply_len += n;
+                answered++;
+            }
+            if (reply_len >= REPLY_BUF_SIZE) {
+                failed = WriteAll(out_fd, reply, reply_len) < 0;
+                reply_len = 0;
+            }
+            p = nl + 1;
+        }
+        len = end - p;
+        memmove(buf, p, len);
+        if (len == QUERY_BUF_SIZE) {
+            // no newline in a full buffer, so the line is refused once and
+            // the rest of it dropped as it arrives
+            if (!skipping) {
+                reply_len += snprintf(reply + reply_len, MAX_REPLY_LEN, "ERR query too long\n");
+                answered++;
+                skipping = 1;
+            }
+            len = 0;
+        }
+
+        if (reply_len > 0 && !failed) {
+            failed = WriteAll(out_fd, reply, reply_len) < 0;
+        }
+        reply_len = 0;
+    }
+    // a last query without a newline
+    if (len > 0 && !skipping && !failed) {
+        int n = Answer(qs, buf, buf + len, reply + reply_len);
+        if (n >= 0) {
+            reply_len += n;
+            answered++;
+        }
+    }
+    if (reply_len > 0) {
+        WriteAll(out_fd, reply, reply_len);
+    }
+    free(buf);
+    free(reply);
+    return answered;
+}
+
+// Thread body: serves one connection until the client closes it
+static void *ServeConnection(void *arg) {
+    connection_t *conn = (connection_t*)arg;
+    ServeQueries(conn->qs, conn->fd, conn->fd);
+    close(conn->fd);
+    free(conn);
+    return NULL;
+}
+
+//==============================================================================
+// Listens on a Unix socket at path, replacing any file already there, and
+// serves each connection on its own thread. Only returns if the socket
+// cannot be set up or stops accepting connections, and then returns -1.
+//==============================================================================
+int ServeSocket(query_service_t *qs, const char *path) {
+    struct sockaddr_un addr;
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        return -1;
+    }
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    unlink(path);
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0 || listen(fd, SOMAXCONN) < 0) {
+        close(fd);
+        return -1;
+    }
+    // a client closing early must not take the whole service down
+    signal(SIGPIPE, SIG_IGN);
+
+    for (;;) {
+        int conn_fd = accept(fd, NULL, NULL);
+        if (conn_fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            break;
+        }
+        connection_t *conn;
+        if ( (conn = (connection_t*)malloc(sizeof(connection_t))) == NULL ) {
+            printf("malloc() error\n");
+            exit(EXIT_FAILURE);
+        }
+        conn->qs = qs;
+        conn->fd = conn_fd;
+        pthread_t id;
+        if (pthread_create(&id, NULL, ServeConnection, conn) != 0) {
+            close(conn_fd);
+            free(conn);
+            continue;
+        }
+        pthread_detach(id);
+    }
+    close(fd);
+    return -1;
+}
+
+void FreeQueryService(query_service_t *qs) {
+    free(qs->population);
+    free(qs);
+}
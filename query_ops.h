@@ -0,0 +1,32 @@
+#ifndef QUERY_OPS_H
+#define QUERY_OPS_H
+
+#include "wt_ops.h"
+#include "locate_ops.h"
+#include "classify_ops.h"
+#include "frozen_ops.h"
+
+// Everything needed to answer queries about a built DCEL, which is no longer
+// changed once queries start, so any number of connections may share it
+typedef struct {
+    face_grid_t *grid;
+    frozen_dcel_t *frozen;
+    int num_face;
+    // total population of the watchtowers in each face
+    int *population;
+} query_service_t;
+
+query_service_t *CreateQueryService(face_grid_t *grid, frozen_dcel_t *frozen,
+    wt_table_t *wts, int threads);
+
+int QueryFace(query_service_t *qs, double x, double y);
+
+int QueryPopulation(query_service_t *qs, int f);
+
+int ServeQueries(query_service_t *qs, int in_fd, int out_fd);
+
+int ServeSocket(query_service_t *qs, const char *path);
+
+void FreeQueryService(query_service_t *qs);
+
+#endif
@@ -0,0 +1,160 @@
+// snapshot_ops.c
+// Saving a built DCEL to a binary file and loading it back
+
+// Handles the following:
+// - Writing either DCEL layout to a snapshot file
+// - Mapping a snapshot file as a flat DCEL, whose arrays are used in place
+//       without copying or allocating per element
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "snapshot_ops.h"
+
+// Size of the snapshot holding the given numbers of elements
+static size_t SnapshotLen(int num_vertex, int num_face, int num_hedge) {
+    return sizeof(snapshot_header_t) + 2*sizeof(double)*(size_t)num_vertex +
+        4*sizeof(double)*(size_t)num_face + sizeof(int32_t)*(size_t)num_face +
+        4*sizeof(int32_t)*(size_t)num_hedge;
+}
+
+static void FillHeader(snapshot_header_t *header, int num_vertex, int num_face, int num_hedge) {
+    memset(header, 0, sizeof(*header));
+    memcpy(header->magic, SNAPSHOT_MAGIC, sizeof(header->magic));
+    header->version = SNAPSHOT_VERSION;
+    header->byte_order = SNAPSHOT_BYTE_ORDER;
+    header->num_vertex = num_vertex;
+    header->num_face = num_face;
+    header->num_hedge = num_hedge;
+}
+
+// Writes a flat DCEL to path, returns 0 on success and -1 on failure
+int FlatSaveSnapshot(flat_dcel_t *dcel, const char *path) {
+    FILE *file;
+    if ((file = fopen(path, "wb")) == NULL) {
+        return -1;
+    }
+    snapshot_header_t header;
+    FillHeader(&header, dcel->num_vertex, dcel->num_face, dcel->num_hedge);
+    int nv = dcel->num_vertex, nf = dcel->num_face, nh = dcel->num_hedge;
+    int ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+        fwrite(dcel->xs, sizeof(double), nv, file) == (size_t)nv &&
+        fwrite(dcel->ys, sizeof(double), nv, file) == (size_t)nv &&
+        fwrite(dcel->face_box, 4*sizeof(double), nf, file) == (size_t)nf &&
+        fwrite(dcel->face_hedge, sizeof(int32_t), nf, file) == (size_t)nf &&
+        fwrite(dcel->h_start, sizeof(int32_t), nh, file) == (size_t)nh &&
+        fwrite(dcel->h_face, sizeof(int32_t), nh, file) == (size_t)nh &&
+        fwrite(dcel->h_next, sizeof(int32_t), nh, file) == (size_t)nh &&
+        fwrite(dcel->h_prev, sizeof(int32_t), nh, file) == (size_t)nh;
+    if (fclose(file) != 0) {
+        ok = 0;
+    }
+    return ok ? 0 : -1;
+}
+
+// Index of a half-edge in the flat layout, where edge e's own half-edge
+// is 2e and its twin is 2e+1
+static int32_t HedgeIndex(dcel_t *dcel, hedge_t *hedge) {
+    return 2*hedge->edge + (dcel->edge_list[hedge->edge]->hedge != hedge);
+}
+
+// Writes a DCEL to path in the same format, returns 0 on success and -1 on
+// failure. Pointers are turned into indices, so the snapshot loads as a flat
+// DCEL describing the same subdivision with the same numbering.
+int SaveSnapshot(dcel_t *dcel, const char *path) {
+    flat_dcel_t *flat = CreateFlatDcel();
+    FlatReserveDcel(flat, dcel->num_vertex, dcel->num_face, 2*dcel->num_edge);
+    int i, e;
+    for (i=0;i<dcel->num_vertex;i++) {
+        FlatAddVertex(flat, dcel->vertex_list[i]->x, dcel->vertex_list[i]->y);
+    }
+    for (i=0;i<dcel->num_face;i++) {
+        FlatAddFace(flat);
+        flat->face_hedge[i] = HedgeIndex(dcel, dcel->face_list[i]->hedge);
+        memcpy(flat->face_box + 4*i, dcel->face_list[i]->box, 4*sizeof(double));
+    }
+    for (e=0;e<dcel->num_edge;e++) {
+        hedge_t *hedge = dcel->edge_list[e]->hedge;
+        int h = FlatAddEdge(flat, hedge->v_start, hedge->v_end,
+            hedge->face, hedge->twin->face);
+        flat->h_next[h] = HedgeIndex(dcel, hedge->next);
+        flat->h_prev[h] = HedgeIndex(dcel, hedge->prev);
+        flat->h_next[h+1] = HedgeIndex(dcel, hedge->twin->next);
+        flat->h_prev[h+1] = HedgeIndex(dcel, hedge->twin->prev);
+    }
+    int result = FlatSaveSnapshot(flat, path);
+    FreeFlatDcel(flat);
+    return result;
+}
+
+//==============================================================================
+// Returns pointer to a flat DCEL mapped from a snapshot file, or NULL if the
+// file cannot be opened or is not a snapshot this build can read.
+// The mapping is private, so the DCEL may be split further without changing
+// the file. Its arrays move into allocated memory the first time it grows.
+//==============================================================================
+flat_dcel_t *LoadSnapshot(const char *path) {
+    int fd;
+    struct stat st;
+    if ((fd = open(path, O_RDONLY)) < 0) {
+        return NULL;
+    }
+    if (fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(snapshot_header_t)) {
+        close(fd);
+        return NULL;
+    }
+    char *map = (char*)mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        return NULL;
+    }
+
+    snapshot_header_t *header = (snapshot_header_t*)map;
+    if (memcmp(header->magic, SNAPSHOT_MAGIC, sizeof(header->magic)) != 0 ||
+        header->version != SNAPSHOT_VERSION ||
+        header->byte_order != SNAPSHOT_BYTE_ORDER ||
+        header->num_vertex < 0 || header->num_face < 0 ||
+        header->num_hedge < 0 || header->num_hedge % 2 != 0 ||
+        SnapshotLen(header->num_vertex, header->num_face, header->num_hedge) !=
+            (size_t)st.st_size) {
+        munmap(map, st.st_size);
+        return NULL;
+    }
+
+    flat_dcel_t *dcel;
+    if ( (dcel = (flat_dcel_t*)malloc(sizeof(flat_dcel_t))) == NULL ) {
+        printf("malloc() error\n");
+        exit(EXIT_FAILURE);
+    }
+    int nv = header->num_vertex, nf = header->num_face, nh = header->num_hedge;
+    dcel->num_vertex = dcel->size_vertex = nv;
+    dcel->num_face = dcel->size_face = nf;
+    dcel->num_hedge = dcel->size_hedge = nh;
+
+    char *p = map + sizeof(snapshot_header_t);
+    dcel->xs = (double*)p;
+    p += sizeof(double)*nv;
+    dcel->ys = (double*)p;
+    p += sizeof(double)*nv;
+    dcel->face_box = (double*)p;
+    p += 4*sizeof(double)*nf;
+    dcel->face_hedge = (int32_t*)p;
+    p += sizeof(int32_t)*nf;
+    dcel->h_start = (int32_t*)p;
+    p += sizeof(int32_t)*nh;
+    dcel->h_face = (int32_t*)p;
+    p += sizeof(int32_t)*nh;
+    dcel->h_next = (int32_t*)p;
+    p += sizeof(int32_t)*nh;
+    dcel->h_prev = (int32_t*)p;
+
+    dcel->face_wts = NULL;
+    dcel->map = map;
+    dcel->map_len = st.st_size;
+    dcel->block = NULL;
+    return dcel;
+}
@@ -0,0 +1,39 @@
+#ifndef SNAPSHOT_OPS_H
+#define SNAPSHOT_OPS_H
+
+#include <stdint.h>
+#include "dcel_ops.h"
+#include "flat_ops.h"
+
+// A snapshot is the flat layout's arrays written out one after another,
+// behind this header, in the machine's own byte order:
+//     xs, ys            num_vertex doubles each
+//     face_box          4*num_face doubles
+//     face_hedge        num_face int32s
+//     h_start, h_face,
+//     h_next, h_prev    num_hedge int32s each
+// Half-edges 2e and 2e+1 are the two halves of edge e, as in the flat layout,
+// so edge numbers given to later splits keep their meaning.
+#define SNAPSHOT_MAGIC "VORDCEL"
+#define SNAPSHOT_VERSION 3
+// Written as is, so a snapshot from a machine of the other byte order is
+// recognised and refused
+#define SNAPSHOT_BYTE_ORDER 0x01020304
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    int32_t num_vertex;
+    int32_t num_face;
+    int32_t num_hedge;
+    int32_t reserved;
+} snapshot_header_t;
+
+int SaveSnapshot(dcel_t *dcel, const char *path);
+
+int FlatSaveSnapshot(flat_dcel_t *dcel, const char *path);
+
+flat_dcel_t *LoadSnapshot(const char *path);
+
+#endif
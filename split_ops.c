@@ -0,0 +1,325 @@
+// split_ops.c
+// Reads and performs batches of splits
+
+// Handles the following:
+// - Reading every split from a file in large buffered chunks
+// - Performing a batch of splits on either DCEL layout
+// - Building a flat DCEL from a polygon and a batch of splits in one go
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+#include "split_ops.h"
+
+// Bytes read from the file at a time
+#define CHUNK_SIZE (1 << 16)
+#define S_START_SIZE 64
+// Longest fraction read, in characters
+#define TOKEN_SIZE 64
+
+// Most fields on a line of a splits file, two indices and two fractions
+#define MAX_SPLIT_FIELDS 4
+
+// The fields of the line being read, not yet added to the splits
+typedef struct {
+    int num;
+    int e[2];
+    double t[2];
+} split_line_t;
+
+static void AddSplitValue(splits_t *splits, int value) {
+    if (splits->num == splits->size) {
+        splits->size*=2;
+        if ( (splits->pairs = (int*)
+        realloc(splits->pairs, sizeof(int)*splits->size)) == NULL ||
+             (splits->at && (splits->at = (double*)
+        realloc(splits->at, sizeof(double)*splits->size)) == NULL) ) {
+            printf("realloc() error\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    if (splits->at) {
+        splits->at[splits->num] = 0.5;
+    }
+    splits->pairs[splits->num++] = value;
+}
+
+// Sets the fraction of index i, giving every other index so far a half
+// the first time any fraction is set
+static void SetSplitFraction(splits_t *splits, int i, double t) {
+    if (splits->at == NULL) {
+        if ( (splits->at = (double*)malloc(sizeof(double)*splits->size)) == NULL ) {
+            printf("malloc() error\n");
+            exit(EXIT_FAILURE);
+        }
+        int j;
+        for (j=0;j<splits->num;j++) {
+            splits->at[j] = 0.5;
+        }
+    }
+    splits->at[i] = t;
+}
+
+// Adds the token just parsed to the fields of its line, as an index if it is
+// one of the first two, which must be written as an integer that big does
+// not mark as out of the range of an int, or else as a fraction.
+// Reports it and returns 0 if it is malformed, or one field too many.
+static int EndSplitToken(splits_t *splits, split_line_t *line, char *token,
+    int length, int is_int, int big, int neg, long value) {
+    if (line->num == MAX_SPLIT_FIELDS) {
+        fprintf(stderr, "Malformed split line after %d indices, no more splits read\n",
+            splits->num);
+        return 0;
+    }
+    if (line->num >= 2) {
+        char *end = token;
+        double t = 0;
+        if (length < TOKEN_SIZE) {
+            token[length] = '\0';
+            t = strtod(token, &end);
+        }
+        if (end != token + length) {
+            fprintf(stderr, "Malformed split fraction after %d indices, no more splits read\n",
+                splits->num);
+            return 0;
+        }
+        line->t[line->num++ - 2] = t;
+        return 1;
+    }
+    if (!is_int || big) {
+        fprintf(stderr, "Malformed split index after %d indices, no more splits read\n",
+            splits->num);
+        return 0;
+    }
+    line->e[line->num++] = (int)(neg ? -value : value);
+    return 1;
+}
+
+// Adds the pair on the line just read, with its fractions if it has them.
+// A blank line is skipped. Reports it and returns 0 if it has any other
+// number of fields than 2 or 4.
+static int EndSplitLine(splits_t *splits, split_line_t *line) {
+    if (line->num == 0) {
+        return 1;
+    }
+    if (line->num != 2 && line->num != 4) {
+        fprintf(stderr, "Malformed split line after %d indices, no more splits read\n",
+            splits->num);
+        return 0;
+    }
+    AddSplitValue(splits, line->e[0]);
+    AddSplitValue(splits, line->e[1]);
+    if (line->num == 4) {
+        SetSplitFraction(splits, splits->num - 2, line->t[0]);
+        SetSplitFraction(splits, splits->num - 1, line->t[1]);
+    }
+    line->num = 0;
+    return 1;
+}
+
+// Reads pairs of edge indices, one pair to a line, until the end of the file.
+// Fields are separated by whitespace, and each index must be an optional sign
+// followed by digits, within the range of an int. A pair may be followed on
+// its line by two fractions t1 and t2, in any form strtod reads, to cut its
+// edges at those fractions of the way along them as SplitFaceAt does. If any
+// pair has them, splits->at is set and every pair without them gets a half
+// for each, which bisects. Blank lines are skipped.
+// The first malformed field, or line with other than 2 or 4 fields, stops
+// the reading there, as a scanf("%d %d") loop stops at anything it cannot
+// read, and is reported on stderr. The pairs before it are kept.
+// The file is read in chunks, with integers parsed by hand as the bytes go
+// past, so a number may start in one chunk and finish in the next.
+splits_t *ReadSplits(FILE *file) {
+    splits_t *splits;
+    if ( (splits = (splits_t*)malloc(sizeof(splits_t))) == NULL ||
+         (splits->pairs = (int*)malloc(sizeof(int)*S_START_SIZE)) == NULL ) {
+        printf("malloc() error\n");
+        exit(EXIT_FAILURE);
+    }
+    splits->num = 0;
+    splits->size = S_START_SIZE;
+    splits->at = NULL;
+
+    char *buf;
+    if ( (buf = (char*)malloc(CHUNK_SIZE)) == NULL ) {
+        printf("malloc() error\n");
+        exit(EXIT_FAILURE);
+    }
+
+    // state of the token being parsed, which is not an int once bad is set
+    char token[TOKEN_SIZE];
+    int length = 0, neg = 0, has_digit = 0, bad = 0, big = 0, stop = 0;
+    split_line_t line = {0};
+    long value = 0;
+    size_t len, i;
+    while (!stop && (len = fread(buf, 1, CHUNK_SIZE, file)) > 0) {
+        for (i=0;i<len && !stop;i++) {
+            char c = buf[i];
+            if (c == ' ' || c == '\n' || c == '\t' || c == '\r' ||
+                c == '\v' || c == '\f') {
+                if (length > 0) {
+                    stop = !EndSplitToken(splits, &line, token, length,
+                        !bad && has_digit, big, neg, value);
+                    length = neg = has_digit = bad = big = 0;
+                    value = 0;
+                }
+                if (c == '\n' && !stop) {
+                    stop = !EndSplitLine(splits, &line);
+                }
+                continue;
+            }
+            if (length < TOKEN_SIZE) {
+                token[length] = c;
+            }
+            if (c >= '0' && c <= '9') {
+                has_digit = 1;
+                // value stays within INT_MAX + 1, so it cannot overflow a long
+                if (!big && (value = value*10 + (c - '0')) > (long)INT_MAX + neg) {
+                    big = 1;
+                }
+            } else if ((c == '-' || c == '+') && length == 0) {
+                neg = (c == '-');
+            } else {
+                bad = 1;
+            }
+            length++;
+        }
+    }
+    // a last line without a newline
+    if (!stop && length > 0) {
+        stop = !EndSplitToken(splits, &line, token, length, !bad && has_digit, big, neg, value);
+    }
+    if (!stop) {
+        EndSplitLine(splits, &line);
+    }
+    free(buf);
+    return splits;
+}
+
+// Returns 1 if edges e1 and e2 can be split together in a DCEL with n edges
+static int ValidSplit(int e1, int e2, int n) {
+    return e1 >= 0 && e2 >= 0 && e1 < n && e2 < n && e1 != e2;
+}
+
+// Returns an array of face numbers for a batch of k splits to keep, starting
+// with every face of the DCEL as it is numbered now
+static int *StartOrder(int num_face, int k) {
+    int *order;
+    if ( (order = (int*)malloc(sizeof(int)*(num_face+k+1))) == NULL ) {
+        printf("malloc() error\n");
+        exit(EXIT_FAILURE);
+    }
+    int f;
+    for (f=0;f<num_face;f++) {
+        order[f] = f;
+    }
+    return order;
+}
+
+// Performs every split in order, and returns how many were performed.
+// The DCEL's lists are grown once up front to fit the whole batch.
+// Splits naming edges that do not exist, or edges which do not both bound
+// the face being split, are skipped and leave the DCEL as it was.
+// No split relabels much more than its smaller side, and the faces are
+// renumbered once at the end, so they are numbered just as if each had been
+// split by SplitFace with no order.
+int ApplySplits(dcel_t *dcel, splits_t *splits) {
+    int i, done = 0;
+    int k = splits->num / 2;
+    ReserveDcel(dcel, dcel->num_vertex + 2*k, dcel->num_face + k, dcel->num_edge + 3*k);
+    int *order = StartOrder(dcel->num_face, k);
+    for (i=0;i<k;i++) {
+        int e1 = splits->pairs[2*i];
+        int e2 = splits->pairs[2*i+1];
+        if (!ValidSplit(e1, e2, dcel->num_edge)) {
+            fprintf(stderr, "Invalid split %d %d skipped\n", e1, e2);
+            continue;
+        }
+        if (splits->at == NULL ? SplitFace(dcel, e1, e2, order) < 0 :
+            SplitFaceAt(dcel, e1, splits->at[2*i], e2, splits->at[2*i+1], order) < 0) {
+            fprintf(stderr, "Invalid split %d %d skipped\n", e1, e2);
+            continue;
+        }
+        done++;
+    }
+    RenumberFaces(dcel, order);
+    free(order);
+    return done;
+}
+
+// Same as ApplySplits, on the flat layout
+int FlatApplySplits(flat_dcel_t *dcel, splits_t *splits) {
+    int i, done = 0;
+    int k = splits->num / 2;
+    FlatReserveDcel(dcel, dcel->num_vertex + 2*k, dcel->num_face + k,
+        dcel->num_hedge + 6*k);
+    int *order = StartOrder(dcel->num_face, k);
+    for (i=0;i<k;i++) {
+        int e1 = splits->pairs[2*i];
+        int e2 = splits->pairs[2*i+1];
+        if (!ValidSplit(e1, e2, dcel->num_hedge / 2)) {
+            fprintf(stderr, "Invalid split %d %d skipped\n", e1, e2);
+            continue;
+        }
+        if (splits->at == NULL ? FlatSplitFace(dcel, e1, e2, order) < 0 :
+            FlatSplitFaceAt(dcel, e1, splits->at[2*i], e2, splits->at[2*i+1], order) < 0) {
+            fprintf(stderr, "Invalid split %d %d skipped\n", e1, e2);
+            continue;
+        }
+        done++;
+    }
+    FlatRenumberFaces(dcel, order);
+    free(order);
+    return done;
+}
+
+//==============================================================================
+// Reads the polygon's vertices from a file and builds a flat DCEL with every
+// split already performed, setting done to how many were.
+// The polygon and the batch fix the final numbers of vertices, faces and
+// half-edges, so the whole DCEL is allocated once at its final size and
+// nothing is reallocated or copied while it is built. The splits themselves
+// are still made one at a time by FlatApplySplits, as which face a split
+// cuts depends on the splits before it.
+//==============================================================================
+flat_dcel_t *BuildFlatDcel(FILE *polygon, splits_t *splits, int *done) {
+    // The vertices are read first, as their number is not known until the end
+    int n = 0, size = S_START_SIZE;
+    double *coords;
+    if ( (coords = (double*)malloc(sizeof(double)*2*size)) == NULL ) {
+        printf("malloc() error\n");
+        exit(EXIT_FAILURE);
+    }
+    double X, Y;
+    while (fscanf(polygon, "%lf %lf", &X, &Y) > 0) {
+        if (n == size) {
+            size*=2;
+            if ( (coords = (double*)realloc(coords, sizeof(double)*2*size)) == NULL ) {
+                printf("realloc() error\n");
+                exit(EXIT_FAILURE);
+            }
+        }
+        coords[2*n] = X;
+        coords[2*n+1] = Y;
+        n++;
+    }
+
+    // Each split adds 2 vertices, 1 face and 3 edges
+    int i;
+    int k = splits->num / 2;
+    flat_dcel_t *dcel = CreateSizedFlatDcel(n + 2*k, 1 + k, 2*n + 6*k);
+    for (i=0;i<n;i++) {
+        FlatAddVertex(dcel, coords[2*i], coords[2*i+1]);
+    }
+    free(coords);
+    FlatClosePolygon(dcel);
+
+    *done = FlatApplySplits(dcel, splits);
+    return dcel;
+}
+
+void FreeSplits(splits_t *splits) {
+    free(splits->pairs);
+    free(splits->at);
+    free(splits);
+}
@@ -0,0 +1,29 @@
+#ifndef SPLIT_OPS_H
+#define SPLIT_OPS_H
+
+#include <stdio.h>
+#include "dcel_ops.h"
+#include "flat_ops.h"
+
+// A sequence of splits, split i cuts edges pairs[2i] and pairs[2i+1].
+// If at is set, the cuts are at fractions at[2i] and at[2i+1] along the
+// edges, measured from each edge's first half-edge, otherwise they bisect them.
+// ReadSplits sets at if the file gives fractions for any pair.
+typedef struct {
+    int num;
+    int size;
+    int *pairs;
+    double *at;
+} splits_t;
+
+splits_t *ReadSplits(FILE *file);
+
+flat_dcel_t *BuildFlatDcel(FILE *polygon, splits_t *splits, int *done);
+
+int ApplySplits(dcel_t *dcel, splits_t *splits);
+
+int FlatApplySplits(flat_dcel_t *dcel, splits_t *splits);
+
+void FreeSplits(splits_t *splits);
+
+#endif
@@ -0,0 +1,52 @@
+// stats_ops.c
+// Instrumentation of voronoi1
+
+// Handles the following:
+// - Holding the phase timings and counters updated through the STAT_ macros
+// - Deciding whether a summary was asked for
+// - Printing the summary as JSON
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "stats_ops.h"
+
+// Set to anything but 0 to get the summary without --stats
+#define STATS_ENV "VORONOI_STATS"
+
+#ifdef VORONOI_STATS
+stats_t stats;
+#endif
+
+// Returns a monotonic time in seconds
+double StatsNow() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Returns 1 if a summary should be printed, given whether --stats was passed
+int StatsRequested(int flag) {
+    char *env = getenv(STATS_ENV);
+    return flag || (env && *env && strcmp(env, "0") != 0);
+}
+
+// Prints the summary as one JSON object
+void PrintStats(FILE *file) {
+#ifdef VORONOI_STATS
+    fprintf(file, "{\"phases_seconds\": {\"load\": %.6f, \"polygon\": %.6f, "
+        "\"track\": %.6f, \"splits\": %.6f, \"output\": %.6f, \"total\": %.6f}, ",
+        stats.load, stats.polygon, stats.track, stats.splits, stats.output,
+        stats.load + stats.polygon + stats.track + stats.splits + stats.output);
+    fprintf(file, "\"counters\": {\"half_plane\": %lld, \"crossing_edges\": %lld, \"orient_exact\": %lld, "
+        "\"box_rejects\": %lld, \"split_faces\": %lld, \"split_hedges\": %lld, \"split_hedges_per_split\": %.2f, "
+        "\"heap_allocs\": %lld, \"heap_bytes\": %lld, \"arena_allocs\": %lld, "
+        "\"bytes_written\": %lld}}\n",
+        stats.half_plane, stats.crossing_edges, stats.orient_exact, stats.box_rejects, stats.split_faces, stats.split_hedges,
+        stats.split_faces ? (double)stats.split_hedges / stats.split_faces : 0.0,
+        stats.heap_allocs, stats.heap_bytes, stats.arena_allocs, stats.bytes_written);
+#else
+    fprintf(file, "{\"error\": \"built without VORONOI_STATS\"}\n");
+#endif
+}
@@ -0,0 +1,57 @@
+#ifndef STATS_OPS_H
+#define STATS_OPS_H
+
+#include <stdio.h>
+
+// Phase timings and hot path counters, printed as JSON with --stats.
+// Only built in when compiled with -DVORONOI_STATS, otherwise every STAT_
+// macro expands to nothing and the counters cost nothing.
+typedef struct {
+    // seconds spent in each phase of voronoi1
+    double load;
+    double polygon;
+    double track;
+    double splits;
+    double output;
+    // half-plane tests, one per point per half-edge
+    long long half_plane;
+    // edges crossing a point's height, checked by the winding number test of
+    // non-convex faces
+    long long crossing_edges;
+    // tests too close to call in doubles, decided by exact arithmetic
+    long long orient_exact;
+    // (watchtower, candidate face) pairs ruled out by the face's bounding box
+    // before any half-plane test
+    long long box_rejects;
+    long long split_faces;
+    // half-edges stepped over while relabelling faces during splits
+    long long split_hedges;
+    // blocks of memory obtained from or resized through the heap by the DCELs
+    long long heap_allocs;
+    long long heap_bytes;
+    // elements handed out by arenas
+    long long arena_allocs;
+    long long bytes_written;
+} stats_t;
+
+#ifdef VORONOI_STATS
+extern stats_t stats;
+#define STAT_ADD(counter, n) (stats.counter += (n))
+// for counters also updated by classification threads
+#define STAT_ADD_SHARED(counter, n) __atomic_fetch_add(&stats.counter, (n), __ATOMIC_RELAXED)
+#define STAT_NOW() StatsNow()
+#define STAT_TIME(phase, since) (stats.phase += StatsNow() - (since))
+#else
+#define STAT_ADD(counter, n) ((void)0)
+#define STAT_ADD_SHARED(counter, n) ((void)0)
+#define STAT_NOW() 0.0
+#define STAT_TIME(phase, since) ((void)(since))
+#endif
+
+double StatsNow();
+
+int StatsRequested(int flag);
+
+void PrintStats(FILE *file);
+
+#endif
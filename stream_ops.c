@@ -0,0 +1,237 @@
+// stream_ops.c
+// Creates the desired output with only a chunk of watchtowers in memory
+
+// Handles the following:
+// - Reading the watchtower csv a chunk of rows at a time
+// - Classifying each chunk and spilling its lines, grouped by face,
+//       to a temporary file
+// - Merging the spilled runs back into the usual face-ordered output
+// Memory holds one chunk, the DCEL, where each face's last run was spilled,
+// as every run links back to the face's run before it, and while merging
+// the places of one face's runs, so the csv itself can be larger than RAM.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "stream_ops.h"
+#include "writer_ops.h"
+#include "output_ops.h"
+
+// Bytes read from the csv at a time, grown if a single line is longer
+#define STREAM_BUF_SIZE (1 << 22)
+// Bytes of a spilled run copied back at a time
+#define MERGE_BUF_SIZE (1 << 16)
+
+// Spilled straight after each run, the len bytes of lines of one face from
+// one chunk. prev is where the run_t after the face's previous run was
+// spilled, or -1 if this is its first run.
+typedef struct {
+    long long prev;
+    long long len;
+} run_t;
+
+//==============================================================================
+// Chunked csv reading
+//==============================================================================
+
+// Returns pointer to a stream over the csv in file, past its heading row,
+// which hands out up to chunk rows at a time
+wt_stream_t *OpenWtStream(FILE *file, int chunk) {
+    wt_stream_t *stream;
+    if ( (stream = (wt_stream_t*)malloc(sizeof(wt_stream_t))) == NULL ||
+         (stream->buf = (char*)malloc(STREAM_BUF_SIZE)) == NULL ) {
+        printf("malloc() error\n");
+        exit(EXIT_FAILURE);
+    }
+    stream->wts = CreateWts(chunk);
+    stream->file = file;
+    stream->len = 0;
+    stream->size = STREAM_BUF_SIZE;
+    stream->pos = 0;
+    stream->eof = 0;
+    stream->chunk = chunk;
+
+    // first row which is just headings
+    int c;
+    while ((c = getc(file)) != EOF && c != '\n');
+    return stream;
+}
+
+// Moves the unread part of the buffer to its front and reads more after it,
+// growing the buffer if it is full of one unfinished line
+static void Refill(wt_stream_t *stream) {
+    memmove(stream->buf, stream->buf + stream->pos, stream->len - stream->pos);
+    stream->len -= stream->pos;
+    stream->pos = 0;
+    if (stream->len == stream->size) {
+        stream->size *= 2;
+        if ( (stream->buf = (char*)realloc(stream->buf, stream->size)) == NULL ) {
+            printf("realloc() error\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    size_t got = fread(stream->buf + stream->len, 1, stream->size - stream->len, stream->file);
+    stream->len += got;
+    if (got == 0) {
+        stream->eof = 1;
+    }
+}
+
+// Parses the next chunk of rows into stream->wts, and returns how many there
+// are, or 0 once the file is finished. Lines with fewer fields are skipped,
+// as MapWtFile does.
+int ReadWtChunk(wt_stream_t *stream) {
+    wt_info_t info;
+    // the table holds copies of the rows, so the buffer may move at any time
+    ClearWts(stream->wts);
+    while (stream->wts->n < stream->chunk) {
+        char *p = stream->buf + stream->pos;
+        char *end = stream->buf + stream->len;
+        char *line_end = (char*)memchr(p, '\n', end - p);
+        if (line_end == NULL) {
+            if (!stream->eof) {
+                Refill(stream);
+                continue;
+            }
+            if (p == end) {
+                break;
+            }
+            // last line without a newline
+            line_end = end;
+        }
+        if (ParseWtLine(p, line_end, &info)) {
+            AddWt(stream->wts, &info);
+        }
+        stream->pos = line_end - stream->buf + (line_end < end);
+    }
+    return stream->wts->n;
+}
+
+void CloseWtStream(wt_stream_t *stream) {
+    free(stream->buf);
+    FreeWts(stream->wts);
+    free(stream);
+}
+
+//==============================================================================
+// Spilling and merging
+//==============================================================================
+
+// Reads the run_t spilled at offset
+static run_t ReadRun(int fd, long long offset) {
+    run_t run;
+    if (pread(fd, &run, sizeof(run), offset) != sizeof(run)) {
+        printf("pread() error\n");
+        exit(EXIT_FAILURE);
+    }
+    return run;
+}
+
+// Copies len bytes at offset in the spill file to the writer
+static void CopyRun(writer_t *writer, int fd, long long offset, long long len, char *buf) {
+    while (len > 0) {
+        ssize_t want = len < MERGE_BUF_SIZE ? len : MERGE_BUF_SIZE;
+        ssize_t got = pread(fd, buf, want, offset);
+        if (got <= 0) {
+            printf("pread() error\n");
+            exit(EXIT_FAILURE);
+        }
+        WriteBytes(writer, buf, got);
+        offset += got;
+        len -= got;
+    }
+}
+
+//==============================================================================
+// For each face, print out the watchtowers which belong to it and add up the
+// populations, the same output as CreateOutput, reading the watchtowers from
+// wt_file a chunk at a time.
+// Each chunk is classified and its lines written to a temporary file grouped
+// by face, as one run per face, which links back to the face's previous run.
+// Once the csv is finished, each face's chain of runs is followed back and
+// then copied out in chunk order, which keeps the watchtowers of a face in
+// input order.
+//==============================================================================
+void StreamOutput(FILE *file, FILE *wt_file, face_grid_t *grid, frozen_dcel_t *frozen,
+    int chunk, int threads) {
+
+    int num_face = frozen->num_face;
+    FILE *spill_file;
+    if ((spill_file = tmpfile()) == NULL) {
+        printf("tmpfile() error\n");
+        exit(EXIT_FAILURE);
+    }
+    writer_t *spill = CreateWriter(spill_file);
+    int *face_populations = (int*)calloc(num_face+1, sizeof(int));
+    long long *last_run = (long long*)malloc(sizeof(long long)*(num_face+1));
+    if (face_populations == NULL || last_run == NULL) {
+        printf("malloc() error\n");
+        exit(EXIT_FAILURE);
+    }
+    int f;
+    for (f=0;f<num_face;f++) {
+        last_run[f] = -1;
+    }
+
+    // classify and spill each chunk, c counts the chunks
+    wt_stream_t *stream = OpenWtStream(wt_file, chunk);
+    int n, c, k;
+    for (c=0;(n = ReadWtChunk(stream)) > 0;c++) {
+        matches_t matches = {0, 0, NULL, NULL};
+        ClassifyWts(grid, frozen, stream->wts, threads, &matches);
+        SortMatches(&matches, n, num_face);
+        for (k=0;k<matches.num;) {
+            f = matches.face[k];
+            long long offset = spill->bytes;
+            for (;k<matches.num && matches.face[k] == f;k++) {
+                WriteWtInfo(spill, stream->wts, matches.wt[k]);
+                face_populations[f] += stream->wts->population[matches.wt[k]];
+            }
+            run_t run = {last_run[f], spill->bytes - offset};
+            last_run[f] = spill->bytes;
+            WriteBytes(spill, (char*)&run, sizeof(run));
+        }
+        free(matches.face);
+        free(matches.wt);
+    }
+    CloseWtStream(stream);
+    FlushWriter(spill);
+    fflush(spill_file);
+
+    // merge, a face has at most one run per chunk
+    long long *starts = (long long*)malloc(sizeof(long long)*(c+1));
+    long long *lens = (long long*)malloc(sizeof(long long)*(c+1));
+    char *buf = (char*)malloc(MERGE_BUF_SIZE);
+    if (starts == NULL || lens == NULL || buf == NULL) {
+        printf("malloc() error\n");
+        exit(EXIT_FAILURE);
+    }
+    writer_t *writer = CreateWriter(file);
+    int fd = fileno(spill_file);
+    for (f=0;f<num_face;f++) {
+        WriteFaceHeader(writer, f);
+        long long at = last_run[f];
+        for (k=0;at >= 0;k++) {
+            run_t run = ReadRun(fd, at);
+            starts[k] = at - run.len;
+            lens[k] = run.len;
+            at = run.prev;
+        }
+        while (k-- > 0) {
+            CopyRun(writer, fd, starts[k], lens[k], buf);
+        }
+    }
+    for (f=0;f<num_face;f++) {
+        WriteFacePopulation(writer, f, face_populations[f]);
+    }
+    FreeWriter(writer);
+
+    FreeWriter(spill);
+    fclose(spill_file);
+    free(starts);
+    free(lens);
+    free(last_run);
+    free(face_populations);
+    free(buf);
+}
@@ -0,0 +1,32 @@
+#ifndef STREAM_OPS_H
+#define STREAM_OPS_H
+
+#include <stdio.h>
+#include "wt_ops.h"
+#include "locate_ops.h"
+#include "classify_ops.h"
+
+// Watchtowers read from a csv file a chunk at a time.
+// Each chunk's rows are copied into wts, which is emptied for the next chunk.
+typedef struct {
+    FILE *file;
+    char *buf;
+    size_t len;
+    size_t size;
+    // start of the first line not yet handed out
+    size_t pos;
+    int eof;
+    int chunk;
+    wt_table_t *wts;
+} wt_stream_t;
+
+wt_stream_t *OpenWtStream(FILE *file, int chunk);
+
+int ReadWtChunk(wt_stream_t *stream);
+
+void CloseWtStream(wt_stream_t *stream);
+
+void StreamOutput(FILE *file, FILE *wt_file, face_grid_t *grid, frozen_dcel_t *frozen,
+    int chunk, int threads);
+
+#endif
@@ -0,0 +1,681 @@
+// test.c
+// Checks the fast paths of voronoi1 against the plain versions they replace
+
+// Usage: voronoi1_test
+//
+// Runs the following checks, printing a line for each, and exits with a
+// failure status if any of them fail:
+// - HalfPlaneBatchWith, at each instruction set the machine supports, against
+//       HalfPlane point by point. The points are random, on the edge's line,
+//       or a few ulps off it, and every count up to a few mask words is tried
+//       from more than one starting offset, so every lane remainder, tail and
+//       misaligned load is covered.
+// - ReadSplits on well formed, malformed and out of range indices, on pairs
+//       with and without fractions along their edges, and on lines with
+//       other than 2 or 4 fields
+// - SplitFaceAt at a half, against SplitFace, for both layouts
+// - SplitFace and FlatSplitFace turning away edges without a common face
+// - Face populations of a polygon with a notch, which leaves a face that is
+//       not convex, classified once the polygon is split and kept up to date
+//       through the split, for both layouts
+// - ParseInt against atoi, at and beyond the ends of an int and a long
+// - FormatFixed against printf("%f") on ties at the sixth decimal place,
+//       values around FIXED_LIMIT and beyond it, negative zero, subnormals,
+//       and random values from well below half a millionth upwards
+// - Orient2d against the exact sign from 128-bit integers, on near degenerate
+//       triples of a scaled integer lattice, some of which need every stage
+// - ServeQueries refusing F and P arguments which are not wholly numbers or
+//       do not fit in an int, and answering the rest
+// Inputs come from a fixed seed, so a failure can be reproduced.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <float.h>
+#include <unistd.h>
+#include "dcel_ops.h"
+#include "flat_ops.h"
+#include "hplane_ops.h"
+#include "split_ops.h"
+#include "output_ops.h"
+#include "wt_ops.h"
+#include "query_ops.h"
+#include "writer_ops.h"
+#include "orient_ops.h"
+
+#define SEED 20003
+// Edges tried against each instruction set
+#define NUM_EDGES 200
+// Every count of points from 0 to MAX_POINTS is tried
+#define MAX_POINTS 200
+// and from each starting offset below MAX_OFFSET
+#define MAX_OFFSET 3
+// Random integers ParseInt reads after its fixed cases
+#define NUM_PARSED 10000
+// Random values FormatFixed writes after its fixed cases
+#define NUM_FIXED 100000
+// Near degenerate triples given to Orient2d
+#define NUM_ORIENT 200000
+
+// Uniform random double in [lo, hi)
+static double Uniform(double lo, double hi) {
+    return lo + (hi - lo) * (rand() / (RAND_MAX + 1.0));
+}
+
+// Moves x by k ulps, up if k is positive and down if negative
+static double Nudge(double x, int k) {
+    for (;k>0;k--) {
+        x = nextafter(x, INFINITY);
+    }
+    for (;k<0;k++) {
+        x = nextafter(x, -INFINITY);
+    }
+    return x;
+}
+
+// Prints the result of a check and returns 1 if it failed
+static int Report(char *name, int failures) {
+    if (failures) {
+        printf("%-44s FAILED (%d mismatches)\n", name, failures);
+    } else {
+        printf("%-44s ok\n", name);
+    }
+    return failures > 0;
+}
+
+//==============================================================================
+// Half-plane kernel
+//==============================================================================
+
+// Picks edge A-->B, as a random segment or one lying along an axis or a
+// diagonal, so points exactly on its line are easy to make
+static void MakeEdge(double *A, double *B) {
+    int kind = rand() % 4;
+    A[0] = Uniform(140, 150);
+    A[1] = Uniform(-42, -32);
+    if (kind == 0) {
+        B[0] = Uniform(140, 150);
+        B[1] = A[1];
+    } else if (kind == 1) {
+        B[0] = A[0];
+        B[1] = Uniform(-42, -32);
+    } else if (kind == 2) {
+        A[0] = 140 + rand() % 10;
+        A[1] = -42 + rand() % 10;
+        double d = (rand() % 2 ? 1 : -1) * (1 + rand() % 8);
+        B[0] = A[0] + d;
+        B[1] = A[1] + d;
+    } else {
+        B[0] = Uniform(140, 150);
+        B[1] = Uniform(-42, -32);
+    }
+}
+
+// Fills in n points against edge A-->B, a mix of random points, points on
+// its line, points a few ulps off it, and its own ends
+static void MakePoints(double *A, double *B, double *xs, double *ys, int n) {
+    int i;
+    for (i=0;i<n;i++) {
+        int kind = rand() % 4;
+        double t = Uniform(-0.5, 1.5);
+        if (kind == 0) {
+            xs[i] = Uniform(140, 150);
+            ys[i] = Uniform(-42, -32);
+        } else if (kind == 1) {
+            // exactly on the line when the edge lies along an axis or a
+            // diagonal, otherwise within rounding of it
+            xs[i] = A[0] + t * (B[0] - A[0]);
+            ys[i] = A[1] + t * (B[1] - A[1]);
+            if (A[1] == B[1]) {
+                ys[i] = A[1];
+            } else if (A[0] == B[0]) {
+                xs[i] = A[0];
+            } else if (fabs(B[0] - A[0]) == fabs(B[1] - A[1])) {
+                double k = (double)(rand() % 17 - 8);
+                xs[i] = A[0] + k;
+                ys[i] = A[1] + (B[1] - A[1] == B[0] - A[0] ? k : -k);
+            }
+        } else if (kind == 2) {
+            xs[i] = Nudge(A[0] + t * (B[0] - A[0]), rand() % 5 - 2);
+            ys[i] = Nudge(A[1] + t * (B[1] - A[1]), rand() % 5 - 2);
+        } else {
+            xs[i] = rand() % 2 ? A[0] : B[0];
+            ys[i] = xs[i] == A[0] ? A[1] : B[1];
+        }
+    }
+}
+
+// Returns the number of points whose bit HalfPlaneBatchWith sets differently
+// from HalfPlane, at instruction set isa, or -1 if the machine lacks it
+static int CheckHalfPlaneBatch(int isa) {
+    int size = MAX_POINTS + MAX_OFFSET;
+    double *xs = (double*)calloc(size, sizeof(double));
+    double *ys = (double*)calloc(size, sizeof(double));
+    uint64_t *mask = (uint64_t*)malloc(sizeof(uint64_t)*(MASK_WORDS(size)+1));
+    int *want = (int*)malloc(sizeof(int)*size);
+    if (xs == NULL || ys == NULL || mask == NULL || want == NULL) {
+        printf("calloc() error\n");
+        exit(EXIT_FAILURE);
+    }
+
+    int e, n, off, i, failures = 0;
+    if (HalfPlaneBatchWith(isa, 0, 0, 1, 0, 1, 0, xs, ys, 0, mask) != isa) {
+        failures = -1;
+    }
+    for (e=0;e<NUM_EDGES && failures >= 0;e++) {
+        double A[2], B[2];
+        MakeEdge(A, B);
+        MakePoints(A, B, xs, ys, size);
+        dcel_t *dcel = CreateDcel();
+        AddVertex(dcel, A[0], A[1]);
+        AddVertex(dcel, B[0], B[1]);
+        for (i=0;i<size;i++) {
+            want[i] = HalfPlane(dcel, 0, 1, xs[i], ys[i]);
+        }
+        FreeDcel(dcel);
+
+        for (off=0;off<MAX_OFFSET;off++) {
+            for (n=0;n<=MAX_POINTS;n++) {
+                // stale bits must be cleared, not left behind
+                memset(mask, 0xff, sizeof(uint64_t)*(MASK_WORDS(size)+1));
+                HalfPlaneBatchWith(isa, A[0], A[1], B[0], B[1], B[0] - A[0],
+                    B[1] - A[1], xs+off, ys+off, n, mask);
+                for (i=0;i<64*MASK_WORDS(n);i++) {
+                    int got = (mask[i >> 6] >> (i & 63)) & 1;
+                    if (got != (i < n ? want[off+i] : 0)) {
+                        failures++;
+                    }
+                }
+            }
+        }
+    }
+
+    free(xs);
+    free(ys);
+    free(mask);
+    free(want);
+    return failures;
+}
+
+//==============================================================================
+// Splits
+//==============================================================================
+
+// Returns pointer to a stream reading the given text
+static FILE *TextFile(char *text) {
+    FILE *file;
+    if ((file = fmemopen(text, strlen(text), "r")) == NULL) {
+        printf("fmemopen() error\n");
+        exit(EXIT_FAILURE);
+    }
+    return file;
+}
+
+// Returns the number of inputs ReadSplits reads differently from expected
+static int CheckReadSplits() {
+    // each input, then how many indices it should give and what they are,
+    // and the fractions, if it should give any
+    struct {
+        char *text;
+        int num;
+        int pairs[4];
+        int has_at;
+        double at[4];
+    } cases[] = {
+        {"0 2\n1 3\n", 4, {0, 2, 1, 3}},
+        {"  0\t2\r\n+1 -3", 4, {0, 2, 1, -3}},
+        {"0 2\n5", 2, {0, 2}},
+        {"0 2\n12-3 5", 2, {0, 2}},
+        {"0 2\n1x 5", 2, {0, 2}},
+        {"0 2\n- 5", 2, {0, 2}},
+        {"0 2\n3 2147483648", 2, {0, 2}},
+        {"0 2\n3 99999999999999999999", 2, {0, 2}},
+        {"0 2\n99999999999999999999 5", 2, {0, 2}},
+        {"2147483647 -2147483648", 2, {2147483647, -2147483647 - 1}},
+        {"", 0, {0}},
+        {"\n0 2\n\n \n1 3\n\n", 4, {0, 2, 1, 3}},
+        {"0\n2\n1 3\n", 0, {0}},
+        {"0 2 1 3\n", 2, {0, 2}, 1, {1, 3}},
+        {"0 2 0.25 0.75\n1 3\n", 4, {0, 2, 1, 3}, 1, {0.25, 0.75, 0.5, 0.5}},
+        {"0 2\n1 3 .5 1e-1", 4, {0, 2, 1, 3}, 1, {0.5, 0.5, 0.5, 0.1}},
+        {"0 2 0.25 1\n1 3", 4, {0, 2, 1, 3}, 1, {0.25, 1, 0.5, 0.5}},
+        {"0 2 0.5\n1 3", 0, {0}},
+        {"0 2\n1 3 0.25", 2, {0, 2}},
+        {"0 2\n1 3 0.25 0.5x", 2, {0, 2}},
+        {"0 2 0.25 0.5 7\n1 3\n", 0, {0}},
+    };
+    int c, i, failures = 0;
+    for (c=0;c<sizeof(cases)/sizeof(cases[0]);c++) {
+        FILE *file = TextFile(cases[c].text);
+        splits_t *splits = ReadSplits(file);
+        fclose(file);
+        int same = splits->num == cases[c].num && (splits->at != NULL) == cases[c].has_at;
+        for (i=0;same && i<splits->num;i++) {
+            same = splits->pairs[i] == cases[c].pairs[i] &&
+                (splits->at == NULL || splits->at[i] == cases[c].at[i]);
+        }
+        if (!same) {
+            printf("  ReadSplits(\"%s\") read %d indices\n", cases[c].text, splits->num);
+            failures++;
+        }
+        FreeSplits(splits);
+    }
+    return failures;
+}
+
+// Returns the number of splits of edges not bounding a common face which
+// either layout performed anyway. The square is cut in two between its left
+// and right edges, so its top and bottom edges no longer share a face.
+static int CheckSplitRejects() {
+    char square[] = "140.9 -39.2\n140.9 -33.9\n150.0 -33.9\n150.0 -39.2\n";
+    int failures = 0;
+    FILE *file = TextFile(square);
+    dcel_t *dcel = CreateDcel();
+    FirstPolygon(dcel, file);
+    fclose(file);
+    failures += SplitFace(dcel, 0, 2, NULL) != 1;
+    failures += SplitFace(dcel, 1, 3, NULL) != -1 || dcel->num_face != 2;
+    FreeDcel(dcel);
+
+    file = TextFile(square);
+    flat_dcel_t *flat = CreateFlatDcel();
+    FlatFirstPolygon(flat, file);
+    fclose(file);
+    failures += FlatSplitFace(flat, 0, 2, NULL) != 1;
+    failures += FlatSplitFace(flat, 1, 3, NULL) != -1 || flat->num_face != 2;
+    FreeFlatDcel(flat);
+    return failures;
+}
+
+// Returns the number of vertices at which cutting a square's top and bottom
+// edges at a half comes out different from bisecting them. The square
+// straddles x = 0, where A + (B - A) / 2 and (A + B) / 2 round differently.
+static int CheckSplitAtHalf() {
+    char square[] = "-1.3 -1\n-1.3 1\n1.0 1\n1.0 -1\n";
+    int failures = 0, v;
+    FILE *file = TextFile(square);
+    dcel_t *bisect = CreateDcel(), *half = CreateDcel();
+    FirstPolygon(bisect, file);
+    rewind(file);
+    FirstPolygon(half, file);
+    fclose(file);
+    SplitFace(bisect, 1, 3, NULL);
+    SplitFaceAt(half, 1, 0.5, 3, 0.5, NULL);
+    for (v=0;v<bisect->num_vertex;v++) {
+        failures += bisect->vertex_list[v]->x != half->vertex_list[v]->x ||
+            bisect->vertex_list[v]->y != half->vertex_list[v]->y;
+    }
+    FreeDcel(bisect);
+    FreeDcel(half);
+
+    file = TextFile(square);
+    flat_dcel_t *flat_bisect = CreateFlatDcel(), *flat_half = CreateFlatDcel();
+    FlatFirstPolygon(flat_bisect, file);
+    rewind(file);
+    FlatFirstPolygon(flat_half, file);
+    fclose(file);
+    FlatSplitFace(flat_bisect, 1, 3, NULL);
+    FlatSplitFaceAt(flat_half, 1, 0.5, 3, 0.5, NULL);
+    for (v=0;v<flat_bisect->num_vertex;v++) {
+        failures += flat_bisect->xs[v] != flat_half->xs[v] ||
+            flat_bisect->ys[v] != flat_half->ys[v];
+    }
+    FreeFlatDcel(flat_bisect);
+    FreeFlatDcel(flat_half);
+    return failures;
+}
+
+//==============================================================================
+// Populations
+//==============================================================================
+
+// A polygon with a notch in its top edge. Cutting it from its left edge to
+// the notch, splitting edges 0 and 2, leaves a face which is not convex.
+#define NOTCH "140.9 -39.2\n140.9 -33.9\n145.0 -33.9\n145.5 -37.0\n" \
+    "146.0 -33.9\n150.0 -33.9\n150.0 -39.2\n"
+// WT1 is right of the notch, but on the far side of the cut's line, WT2 is
+// left of the cut, WT3 is below it and WT4 is on the bottom edge
+#define NOTCH_WTS "Watchtower ID,Postcode,Population Served," \
+    "Watchtower Point of Contact Name,x,y\n" \
+    "WT1,3000,10,Alpha,148.0,-34.5\n" \
+    "WT2,3000,20,Beta,142.0,-34.5\n" \
+    "WT3,3000,40,Gamma,143.0,-38.0\n" \
+    "WT4,3000,80,Delta,143.0,-39.2\n"
+// Populations of the two faces once cut, WT4 being in neither
+#define NOTCH_POP0 50
+#define NOTCH_POP1 20
+
+// Returns the number of faces of the cut notch whose watchtowers, classified
+// against the frozen DCEL, do not add up to the expected population.
+// Frees the grid and the frozen DCEL.
+static int FrozenNotchMismatches(face_grid_t *grid, frozen_dcel_t *frozen,
+    wt_table_t *wts) {
+    face_wts_t *fw = TrackFaceWts(grid, frozen, wts, 1);
+    int failures = frozen->num_face != 2 || FacePopulation(fw, 0) != NOTCH_POP0 ||
+        FacePopulation(fw, 1) != NOTCH_POP1;
+    FreeFaceWts(fw);
+    FreeFrozenDcel(frozen);
+    FreeFaceGrid(grid);
+    return failures;
+}
+
+// Returns 1 if the watchtowers kept up to date through the cut do not add up
+// to the expected populations. Frees the groups.
+static int TrackedNotchMismatches(face_wts_t *fw) {
+    int failures = fw->num_face != 2 || FacePopulation(fw, 0) != NOTCH_POP0 ||
+        FacePopulation(fw, 1) != NOTCH_POP1;
+    FreeFaceWts(fw);
+    return failures;
+}
+
+// Groups the watchtowers by face of the uncut notch, as -i does
+static face_wts_t *TrackNotch(face_grid_t *grid, frozen_dcel_t *frozen,
+    wt_table_t *wts) {
+    face_wts_t *fw = TrackFaceWts(grid, frozen, wts, 1);
+    FreeFrozenDcel(frozen);
+    FreeFaceGrid(grid);
+    return fw;
+}
+
+// Returns the number of ways of classifying the watchtowers of NOTCH_WTS
+// against the cut notch which get either face's population wrong
+static int CheckNotchPopulations() {
+    int failures = 0;
+    FILE *file = TextFile(NOTCH_WTS);
+    wt_table_t *wts = ReadWtInfo(file);
+    fclose(file);
+
+    file = TextFile(NOTCH);
+    dcel_t *dcel = CreateDcel();
+    FirstPolygon(dcel, file);
+    fclose(file);
+    SplitFace(dcel, 0, 2, NULL);
+    failures += FrozenNotchMismatches(CreateFaceGrid(dcel), FreezeDcel(dcel), wts);
+    FreeDcel(dcel);
+
+    file = TextFile(NOTCH);
+    flat_dcel_t *flat = CreateFlatDcel();
+    FlatFirstPolygon(flat, file);
+    fclose(file);
+    FlatSplitFace(flat, 0, 2, NULL);
+    failures += FrozenNotchMismatches(CreateFlatFaceGrid(flat), FreezeFlatDcel(flat), wts);
+    FreeFlatDcel(flat);
+
+    // kept up to date through the cut, both on its own and in a batch
+    file = TextFile("0 2\n");
+    splits_t *splits = ReadSplits(file);
+    fclose(file);
+    int batch;
+    for (batch=0;batch<2;batch++) {
+        file = TextFile(NOTCH);
+        dcel = CreateDcel();
+        FirstPolygon(dcel, file);
+        fclose(file);
+        dcel->face_wts = TrackNotch(CreateFaceGrid(dcel), FreezeDcel(dcel), wts);
+        if (batch) {
+            ApplySplits(dcel, splits);
+        } else {
+            SplitFace(dcel, 0, 2, NULL);
+        }
+        failures += TrackedNotchMismatches(dcel->face_wts);
+        FreeDcel(dcel);
+
+        file = TextFile(NOTCH);
+        flat = CreateFlatDcel();
+        FlatFirstPolygon(flat, file);
+        fclose(file);
+        flat->face_wts = TrackNotch(CreateFlatFaceGrid(flat), FreezeFlatDcel(flat), wts);
+        if (batch) {
+            FlatApplySplits(flat, splits);
+        } else {
+            FlatSplitFace(flat, 0, 2, NULL);
+        }
+        failures += TrackedNotchMismatches(flat->face_wts);
+        FreeFlatDcel(flat);
+    }
+    FreeSplits(splits);
+
+    FreeWts(wts);
+    return failures;
+}
+
+//==============================================================================
+// Parsing
+//==============================================================================
+
+// Returns the number of integers ParseInt reads differently from atoi, over
+// fixed cases at and beyond the ends of an int and a long, then random ones
+static int CheckParseInt() {
+    char *cases[] = {"0", "-0", "+7", "  42", "\t-42", "12x", "-", "", "x1",
+        "2147483647", "2147483648", "-2147483648", "-2147483649", "4294967296",
+        "9223372036854775807", "9223372036854775808", "-9223372036854775808",
+        "-9223372036854775809", "99999999999999999999", "-99999999999999999999",
+        "000000000000000000000000000012", "18446744073709551616"};
+    int c, failures = 0;
+    char text[32];
+    for (c=0;c<sizeof(cases)/sizeof(cases[0])+NUM_PARSED;c++) {
+        char *s = text;
+        if (c < sizeof(cases)/sizeof(cases[0])) {
+            s = cases[c];
+        } else {
+            // up to 22 digits, so every length up to past a long is seen
+            int k, digits = 1 + rand() % 22;
+            int at = 0;
+            if (rand() % 2) {
+                text[at++] = '-';
+            }
+            for (k=0;k<digits;k++) {
+                text[at++] = '0' + rand() % 10;
+            }
+            text[at] = '\0';
+        }
+        if (ParseInt(s, s + strlen(s)) != atoi(s)) {
+            printf("  ParseInt(\"%s\") gave %d, atoi %d\n", s,
+                ParseInt(s, s + strlen(s)), atoi(s));
+            failures++;
+        }
+    }
+    return failures;
+}
+
+// Returns 1 if FormatFixed does not give the text of printf("%f", v)
+static int FixedDiffers(double v) {
+    char got[FIXED_LEN+1], want[FIXED_LEN+1];
+    int len = FormatFixed(got, v);
+    got[len] = '\0';
+    snprintf(want, sizeof(want), "%f", v);
+    if (strcmp(got, want) != 0) {
+        printf("  FormatFixed(%a) gave %s, printf %s\n", v, got, want);
+        return 1;
+    }
+    return 0;
+}
+
+// Returns the number of values FormatFixed formats differently from printf:
+// fixed cases, ties at the sixth decimal place and values around them, values
+// around FIXED_LIMIT and those beyond it which go through snprintf, then
+// random values over a wide range of magnitudes
+static int CheckFormatFixed() {
+    double cases[] = {0.0, -0.0, 1.0, -1.0, 0.5e-6, 1.5e-6, 2.5e-6, 0.4999995,
+        DBL_MIN, -DBL_MIN, 4.9e-324, -4.9e-324, DBL_MAX, -DBL_MAX, 1e20,
+        INFINITY, -INFINITY, NAN};
+    int c, k, failures = 0;
+    for (c=0;c<sizeof(cases)/sizeof(cases[0]);c++) {
+        for (k=-2;k<=2;k++) {
+            failures += FixedDiffers(Nudge(cases[c], k));
+        }
+    }
+    // i/128 for odd i is a tie at the sixth place, as 10^6 = 2^6 * 5^6, so
+    // these should go to even, and a few ulps either side should not
+    for (c=1;c<2*128;c+=2) {
+        for (k=-2;k<=2;k++) {
+            failures += FixedDiffers(Nudge(c / 128.0, k));
+            failures += FixedDiffers(Nudge(-(12345 + c / 128.0), k));
+        }
+    }
+    // the largest values done by hand, and the smallest through snprintf
+    for (k=-4;k<=4;k++) {
+        failures += FixedDiffers(Nudge(FIXED_LIMIT, k));
+        failures += FixedDiffers(Nudge(-FIXED_LIMIT, k));
+        failures += FixedDiffers(Nudge(ldexp(1, 53), k));
+    }
+    for (c=0;c<NUM_FIXED;c++) {
+        // magnitudes from 1e-12, where everything rounds to zero, to beyond
+        // FIXED_LIMIT, and values within a few ulps of half a millionth
+        double v = Uniform(-1, 1) * pow(10, Uniform(-12, 12));
+        failures += FixedDiffers(v);
+        failures += FixedDiffers(Nudge((rand() % 1000000 + 0.5) * 1e-6, rand() % 5 - 2));
+    }
+    return failures;
+}
+
+//==============================================================================
+// Orientation
+//==============================================================================
+
+// Random integer of magnitude below 2^bits, for bits up to 62
+static long long RandomBits(int bits) {
+    unsigned long long r = ((unsigned long long)rand() << 40) ^
+        ((unsigned long long)rand() << 20) ^ (unsigned long long)rand();
+    long long v = (long long)(r & (((unsigned long long)1 << bits) - 1));
+    return rand() % 2 ? -v : v;
+}
+
+// Sign of the orientation determinant of points with integer coordinates
+// below 2^61, computed exactly in 128 bits
+static int ExactOrient(long long *A, long long *B, long long *P) {
+    __int128 det = (__int128)(P[0] - A[0]) * (B[1] - A[1]) -
+        (__int128)(B[0] - A[0]) * (P[1] - A[1]);
+    return (det > 0) - (det < 0);
+}
+
+// Returns the number of triples for which Orient2d, with its arguments in
+// any cyclic order, differs from the exact sign. Each triple is points of an
+// integer lattice along a random line, with P either on it or one step off.
+// The coordinates are rounded to doubles, which takes those above 2^53 a
+// little off the line, and so do not always have exact differences, which
+// is what sends Orient2d past its first exact stage. They are then scaled by
+// a power of two, which keeps them exact and leaves the sign alone.
+static int CheckOrient2d() {
+    int c, k, failures = 0;
+    for (c=0;c<NUM_ORIENT;c++) {
+        int d_bits = rand() % 21;
+        long long A[2], B[2], P[2], d[2] = {RandomBits(d_bits), RandomBits(d_bits)};
+        long long s = RandomBits(59 - d_bits), t = RandomBits(59 - d_bits);
+        int a_bits = rand() % 60;
+        int off = rand() % 2;
+        for (k=0;k<2;k++) {
+            A[k] = RandomBits(a_bits);
+            B[k] = A[k] + s * d[k];
+            P[k] = A[k] + t * d[k] + (off ? rand() % 3 - 1 : 0);
+            A[k] = (long long)(double)A[k];
+            B[k] = (long long)(double)B[k];
+            P[k] = (long long)(double)P[k];
+        }
+        int scale = rand() % 101 - 50;
+        double a[2], b[2], p[2];
+        for (k=0;k<2;k++) {
+            a[k] = ldexp((double)A[k], scale);
+            b[k] = ldexp((double)B[k], scale);
+            p[k] = ldexp((double)P[k], scale);
+        }
+        int want = ExactOrient(A, B, P);
+        if (Orient2d(a[0], a[1], b[0], b[1], p[0], p[1]) != want ||
+            Orient2d(b[0], b[1], p[0], p[1], a[0], a[1]) != want ||
+            Orient2d(p[0], p[1], a[0], a[1], b[0], b[1]) != want) {
+            if (failures < 10) {
+                printf("  Orient2d(%a, %a, %a, %a, %a, %a) should be %d\n",
+                    a[0], a[1], b[0], b[1], p[0], p[1], want);
+            }
+            failures++;
+        }
+    }
+    return failures;
+}
+
+//==============================================================================
+// Queries
+//==============================================================================
+
+// Queries about the cut notch, with arguments which are not wholly numbers
+// or do not fit in an int, and the replies they should get
+#define QUERIES "P abc\nP 1x\nF abc def\nF 148.0 -34.5x\nP 99999999999\n" \
+    "P -99999999999999999999\nP 1\nP +1\nF 148.0 -34.5\nF 1.48e2 -3.45e1\nN\n"
+#define REPLIES "ERR bad argument\nERR bad argument\nERR bad argument\n" \
+    "ERR bad argument\nERR bad argument\nERR bad argument\n" "20\n20\n0\n0\n2\n"
+
+// Returns 1 if ServeQueries, fed QUERIES through a pipe, does not reply
+// with exactly REPLIES
+static int CheckQueryArguments() {
+    FILE *file = TextFile(NOTCH_WTS);
+    wt_table_t *wts = ReadWtInfo(file);
+    fclose(file);
+    file = TextFile(NOTCH);
+    dcel_t *dcel = CreateDcel();
+    FirstPolygon(dcel, file);
+    fclose(file);
+    SplitFace(dcel, 0, 2, NULL);
+    face_grid_t *grid = CreateFaceGrid(dcel);
+    frozen_dcel_t *frozen = FreezeDcel(dcel);
+    query_service_t *qs = CreateQueryService(grid, frozen, wts, 1);
+
+    // both fit in a pipe's buffer, so one thread can do all of it
+    int in[2], out[2];
+    if (pipe(in) < 0 || pipe(out) < 0) {
+        return 1;
+    }
+    write(in[1], QUERIES, strlen(QUERIES));
+    close(in[1]);
+    ServeQueries(qs, in[0], out[1]);
+    close(in[0]);
+    close(out[1]);
+    char got[sizeof(REPLIES) + 256];
+    size_t len = 0;
+    ssize_t n;
+    while ((n = read(out[0], got + len, sizeof(got) - 1 - len)) > 0) {
+        len += n;
+    }
+    got[len] = '\0';
+    close(out[0]);
+
+    FreeQueryService(qs);
+    FreeFrozenDcel(frozen);
+    FreeFaceGrid(grid);
+    FreeDcel(dcel);
+    FreeWts(wts);
+    return strcmp(got, REPLIES) != 0;
+}
+
+int main(int argc, char **argv) {
+    srand(SEED);
+    int failed = 0;
+
+    char *isa_names[3] = {"HalfPlaneBatchWith scalar", "HalfPlaneBatchWith SSE2",
+        "HalfPlaneBatchWith AVX2"};
+    int isa;
+    for (isa=HPLANE_SCALAR;isa<=HPLANE_AVX2;isa++) {
+        int failures = CheckHalfPlaneBatch(isa);
+        if (failures < 0) {
+            printf("%-44s skipped, not supported\n", isa_names[isa]);
+        } else {
+            failed += Report(isa_names[isa], failures);
+        }
+    }
+
+    failed += Report("ReadSplits", CheckReadSplits());
+    failed += Report("SplitFace without a common face", CheckSplitRejects());
+    failed += Report("SplitFaceAt at a half", CheckSplitAtHalf());
+    failed += Report("Populations of a notched polygon", CheckNotchPopulations());
+    failed += Report("ParseInt against atoi", CheckParseInt());
+    failed += Report("FormatFixed against printf", CheckFormatFixed());
+    failed += Report("Orient2d against exact integers", CheckOrient2d());
+    failed += Report("Query arguments", CheckQueryArguments());
+
+    if (failed) {
+        printf("%d checks failed\n", failed);
+        return EXIT_FAILURE;
+    }
+    printf("all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,158 @@
+// writer_ops.c
+// Buffered output
+
+// Handles the following:
+// - Gathering output in a large buffer and writing it out in big blocks
+// - Formatting integers like printf's %d
+// - Formatting doubles like printf's %f, i.e. rounded to 6 decimal places
+// - Flushing and freeing the writer
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include "writer_ops.h"
+#include "stats_ops.h"
+
+#define WRITER_SIZE (1 << 20)
+
+// Returns pointer to a writer which writes to file
+writer_t *CreateWriter(FILE *file) {
+    writer_t *writer;
+    if ( (writer = (writer_t*)malloc(sizeof(writer_t))) == NULL ||
+         (writer->buf = (char*)malloc(WRITER_SIZE)) == NULL ) {
+        printf("malloc() error\n");
+        exit(EXIT_FAILURE);
+    }
+    writer->file = file;
+    writer->len = 0;
+    writer->size = WRITER_SIZE;
+    writer->bytes = 0;
+    return writer;
+}
+
+// Writes out everything buffered so far
+void FlushWriter(writer_t *writer) {
+    if (writer->len > 0) {
+        fwrite(writer->buf, 1, writer->len, writer->file);
+        STAT_ADD_SHARED(bytes_written, writer->len);
+        writer->len = 0;
+    }
+}
+
+void WriteBytes(writer_t *writer, const char *s, size_t len) {
+    writer->bytes += len;
+    if (writer->len + len > writer->size) {
+        FlushWriter(writer);
+        // too big to be worth buffering
+        if (len > writer->size) {
+            fwrite(s, 1, len, writer->file);
+            STAT_ADD_SHARED(bytes_written, len);
+            return;
+        }
+    }
+    memcpy(writer->buf + writer->len, s, len);
+    writer->len += len;
+}
+
+void WriteString(writer_t *writer, const char *s) {
+    WriteBytes(writer, s, strlen(s));
+}
+
+void WriteInt(writer_t *writer, int value) {
+    char num[INT_LEN];
+    WriteBytes(writer, num, FormatInt(num, value));
+}
+
+void WriteFixed(writer_t *writer, double value) {
+    char num[FIXED_LEN];
+    WriteBytes(writer, num, FormatFixed(num, value));
+}
+
+//==============================================================================
+// Number formatting, each function writes the text to out and returns
+// its length. out is not terminated, and must have room for INT_LEN
+// characters for FormatInt and FIXED_LEN for FormatFixed.
+//==============================================================================
+
+// Writes the decimal digits of v, at least min_digits of them
+static int FormatDigits(char *out, uint64_t v, int min_digits) {
+    char rev[24];
+    int n = 0, i;
+    do {
+        rev[n++] = '0' + v % 10;
+        v /= 10;
+    } while (v || n < min_digits);
+    for (i=0;i<n;i++) {
+        out[i] = rev[n-1-i];
+    }
+    return n;
+}
+
+// Same text as printf("%d", value)
+int FormatInt(char *out, int value) {
+    int len = 0;
+    long long v = value;
+    if (v < 0) {
+        out[len++] = '-';
+        v = -v;
+    }
+    return len + FormatDigits(out+len, (uint64_t)v, 1);
+}
+
+//==============================================================================
+// Same text as printf("%f", value).
+// printf rounds the exact binary value to 6 decimal places, with exact ties
+// going to even. Writing |value| = m * 2^e with m a 53-bit integer, the
+// rounded result is m * 10^6 * 2^e rounded to an integer. m * 10^6 fits in
+// 73 bits, so with 128-bit arithmetic the shift and the rounding are exact.
+// Infinities, NaNs and values of FIXED_LIMIT or more go through snprintf.
+//==============================================================================
+int FormatFixed(char *out, double value) {
+    if (!isfinite(value) || fabs(value) >= FIXED_LIMIT) {
+        return snprintf(out, FIXED_LEN, "%f", value);
+    }
+
+    int len = 0;
+    if (signbit(value)) {
+        out[len++] = '-';
+        value = -value;
+    }
+
+    int exp;
+    double frac = frexp(value, &exp);
+    uint64_t m = (uint64_t)ldexp(frac, 53);
+    int e = exp - 53;
+    uint64_t scaled;
+    if (e >= 0) {
+        // an integer below 2^34, so times 10^6 is still exact
+        scaled = (uint64_t)value * 1000000;
+    } else {
+        unsigned __int128 n = (unsigned __int128)m * 1000000;
+        int shift = -e;
+        if (shift >= 127) {
+            scaled = 0;
+        } else {
+            unsigned __int128 one = 1;
+            unsigned __int128 rem = n & ((one << shift) - 1);
+            unsigned __int128 half = one << (shift - 1);
+            scaled = (uint64_t)(n >> shift);
+            if (rem > half || (rem == half && (scaled & 1))) {
+                scaled++;
+            }
+        }
+    }
+
+    len += FormatDigits(out+len, scaled / 1000000, 1);
+    out[len++] = '.';
+    len += FormatDigits(out+len, scaled % 1000000, 6);
+    return len;
+}
+
+// Flushes and frees the writer, but does not close its file
+void FreeWriter(writer_t *writer) {
+    FlushWriter(writer);
+    free(writer->buf);
+    free(writer);
+}
@@ -0,0 +1,43 @@
+#ifndef WRITER_OPS_H
+#define WRITER_OPS_H
+
+#include <stdio.h>
+#include <stddef.h>
+
+// Room needed for the text of any int printed by FormatInt, and of any
+// double printed by FormatFixed
+#define INT_LEN 16
+#define FIXED_LEN 320
+// FormatFixed formats values below this by hand, larger ones through snprintf
+#define FIXED_LIMIT 9007199254.0
+
+// Output gathered in a large buffer and handed to the file in big blocks.
+// Numbers are formatted by hand, to the same text printf would produce.
+typedef struct {
+    FILE *file;
+    char *buf;
+    size_t len;
+    size_t size;
+    // total bytes written through the writer
+    size_t bytes;
+} writer_t;
+
+writer_t *CreateWriter(FILE *file);
+
+void WriteBytes(writer_t *writer, const char *s, size_t len);
+
+void WriteString(writer_t *writer, const char *s);
+
+void WriteInt(writer_t *writer, int value);
+
+void WriteFixed(writer_t *writer, double value);
+
+int FormatInt(char *out, int value);
+
+int FormatFixed(char *out, double value);
+
+void FlushWriter(writer_t *writer);
+
+void FreeWriter(writer_t *writer);
+
+#endif
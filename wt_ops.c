@@ -1,113 +1,594 @@
 // wt_ops.c
 // Reads, prints, frees watchtower information
 
+// Handles the following:
+// - Storing watchtowers in a columnar table with one string pool,
+//       interning postcodes
+// - Loading the csv file with getline or by mapping it, optionally
+//       parsing byte ranges of the mapping on several threads
+// - Parsing csv fields and numbers
+// - Printing and freeing the table
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include "wt_ops.h"
 
 #define MAX_LINE_LEN 512
 #define WT_START_SIZE 10
+// Longest number handed to strtod without a malloc'd copy
+#define MAX_NUM_LEN 64
+#define POOL_START_SIZE 4096
+#define INTERN_START_SIZE 64
+// Smallest share of a csv file worth parsing on a thread of its own
+#define MIN_RANGE_LEN (1 << 20)
 
-// Reads watchtower information from the csv file and returns an array
-// of wt_info_t pointers.
-// Also updates the number of watchtowers as the file is read.
-// realloc usage idea from https://people.eng.unimelb.edu.au/ammoffat/ppsaa/c/realloc.c
-wt_info_t **ReadWtInfo(FILE *file, int *n) {
-    wt_info_t **watchtowers;
-    int currentSize = WT_START_SIZE;
-    if ( (watchtowers = (wt_info_t**)malloc(sizeof(wt_info_t*)*currentSize)) == NULL ) {
+// One thread's share of a csv file, and the table it is parsed into
+typedef struct {
+    char *start;
+    char *end;
+    wt_table_t *wts;
+    // where the range's rows and pool go in the merged table, and the
+    // merged index of each of the range's postcodes
+    wt_table_t *merged;
+    int row_base;
+    size_t pool_base;
+    int *postcode_map;
+} wt_range_t;
+
+//==============================================================================
+// The watchtower table
+//==============================================================================
+
+// Returns pointer to an empty table with room for size watchtowers
+wt_table_t *CreateWts(int size) {
+    wt_table_t *wts;
+    if (size < WT_START_SIZE) {
+        size = WT_START_SIZE;
+    }
+    if ( (wts = (wt_table_t*)malloc(sizeof(wt_table_t))) == NULL ||
+         (wts->x = (double*)malloc(sizeof(double)*size)) == NULL ||
+         (wts->y = (double*)malloc(sizeof(double)*size)) == NULL ||
+         (wts->population = (int*)malloc(sizeof(int)*size)) == NULL ||
+         (wts->ID = (size_t*)malloc(sizeof(size_t)*size)) == NULL ||
+         (wts->contact_name = (size_t*)malloc(sizeof(size_t)*size)) == NULL ||
+         (wts->postcode = (int*)malloc(sizeof(int)*size)) == NULL ||
+         (wts->postcodes = (size_t*)malloc(sizeof(size_t)*INTERN_START_SIZE)) == NULL ||
+         (wts->intern = (int*)malloc(sizeof(int)*INTERN_START_SIZE)) == NULL ||
+         (wts->pool = (char*)malloc(POOL_START_SIZE)) == NULL ) {
         printf("malloc() error\n");
         exit(EXIT_FAILURE);
     }
+    wts->n = 0;
+    wts->size = size;
+    wts->size_postcodes = INTERN_START_SIZE;
+    wts->intern_size = INTERN_START_SIZE;
+    wts->pool_size = POOL_START_SIZE;
+    ClearWts(wts);
+    return wts;
+}
+
+// Empties the table, keeping its memory for reuse
+void ClearWts(wt_table_t *wts) {
+    int i;
+    wts->n = 0;
+    wts->num_postcodes = 0;
+    wts->pool_len = 0;
+    for (i=0;i<wts->intern_size;i++) {
+        wts->intern[i] = -1;
+    }
+}
+
+// Copies len bytes of s into the pool, terminated, and returns their offset
+static size_t PoolAdd(wt_table_t *wts, const char *s, size_t len) {
+    if (wts->pool_len + len + 1 > wts->pool_size) {
+        while (wts->pool_len + len + 1 > wts->pool_size) {
+            wts->pool_size*=2;
+        }
+        if ( (wts->pool = (char*)realloc(wts->pool, wts->pool_size)) == NULL ) {
+            printf("realloc() error\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    size_t offset = wts->pool_len;
+    memcpy(wts->pool + offset, s, len);
+    wts->pool[offset + len] = '\0';
+    wts->pool_len += len + 1;
+    return offset;
+}
+
+// FNV-1a hash of a string
+static uint32_t HashString(const char *s, size_t len) {
+    uint32_t hash = 2166136261u;
+    size_t i;
+    for (i=0;i<len;i++) {
+        hash = (hash ^ (unsigned char)s[i]) * 16777619u;
+    }
+    return hash;
+}
+
+// Doubles the hash table and reinserts every postcode
+static void GrowIntern(wt_table_t *wts) {
+    int i;
+    free(wts->intern);
+    wts->intern_size*=2;
+    if ( (wts->intern = (int*)malloc(sizeof(int)*wts->intern_size)) == NULL ) {
+        printf("malloc() error\n");
+        exit(EXIT_FAILURE);
+    }
+    for (i=0;i<wts->intern_size;i++) {
+        wts->intern[i] = -1;
+    }
+    for (i=0;i<wts->num_postcodes;i++) {
+        char *s = wts->pool + wts->postcodes[i];
+        uint32_t slot = HashString(s, strlen(s)) & (wts->intern_size - 1);
+        while (wts->intern[slot] >= 0) {
+            slot = (slot + 1) & (wts->intern_size - 1);
+        }
+        wts->intern[slot] = i;
+    }
+}
+
+// Returns the index of postcode s in the table's distinct postcodes,
+// adding it to the pool the first time it is seen
+static int Intern(wt_table_t *wts, const char *s) {
+    size_t len = strlen(s);
+    uint32_t slot = HashString(s, len) & (wts->intern_size - 1);
+    int p;
+    while ((p = wts->intern[slot]) >= 0) {
+        if (strcmp(wts->pool + wts->postcodes[p], s) == 0) {
+            return p;
+        }
+        slot = (slot + 1) & (wts->intern_size - 1);
+    }
+    if (wts->num_postcodes == wts->size_postcodes) {
+        wts->size_postcodes*=2;
+        if ( (wts->postcodes = (size_t*)
+        realloc(wts->postcodes, sizeof(size_t)*wts->size_postcodes)) == NULL ) {
+            printf("realloc() error\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    p = wts->num_postcodes++;
+    wts->postcodes[p] = PoolAdd(wts, s, len);
+    wts->intern[slot] = p;
+    // keep the table at most half full
+    if (2*wts->num_postcodes > wts->intern_size) {
+        GrowIntern(wts);
+    }
+    return p;
+}
 
+// Appends a parsed watchtower to the table, copying its strings into the
+// pool, and returns its index
+int AddWt(wt_table_t *wts, wt_info_t *info) {
+    // reallocate space if not enough
+    if (wts->n == wts->size) {
+        wts->size*=2;
+        if ( (wts->x = (double*)realloc(wts->x, sizeof(double)*wts->size)) == NULL ||
+             (wts->y = (double*)realloc(wts->y, sizeof(double)*wts->size)) == NULL ||
+             (wts->population = (int*)realloc(wts->population, sizeof(int)*wts->size)) == NULL ||
+             (wts->ID = (size_t*)realloc(wts->ID, sizeof(size_t)*wts->size)) == NULL ||
+             (wts->contact_name = (size_t*)
+                realloc(wts->contact_name, sizeof(size_t)*wts->size)) == NULL ||
+             (wts->postcode = (int*)realloc(wts->postcode, sizeof(int)*wts->size)) == NULL ) {
+            printf("realloc() error\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    int w = wts->n++;
+    wts->x[w] = info->x;
+    wts->y[w] = info->y;
+    wts->population[w] = info->population;
+    wts->ID[w] = PoolAdd(wts, info->ID, strlen(info->ID));
+    wts->contact_name[w] = PoolAdd(wts, info->contact_name, strlen(info->contact_name));
+    wts->postcode[w] = Intern(wts, info->postcode);
+    return w;
+}
+
+//==============================================================================
+// Loading
+//==============================================================================
+
+// Reads watchtower information from the csv file into a new table.
+// realloc usage idea from https://people.eng.unimelb.edu.au/ammoffat/ppsaa/c/realloc.c
+wt_table_t *ReadWtInfo(FILE *file) {
+    wt_table_t *wts = CreateWts(WT_START_SIZE);
+    wt_info_t info;
     char *line = NULL;
     size_t lineBufferLength = MAX_LINE_LEN;
+    ssize_t len;
 
     // first row which is just headings
     getline(&line, &lineBufferLength, file);
 
-    // remaining rows
-    while (getline(&line, &lineBufferLength, file) > 0) {
-        // reallocate space if not enough
-        if (*n == currentSize) {
-            currentSize*=2;
-            if ( (watchtowers = (wt_info_t**)
-            realloc(watchtowers, sizeof(wt_info_t*)*currentSize)) == NULL ) {
-                printf("realloc() error\n");
-                exit(EXIT_FAILURE);
-            }
+    // remaining rows, lines with fewer fields are skipped
+    while ((len = getline(&line, &lineBufferLength, file)) > 0) {
+        if (ParseWtLine(line, line + len, &info)) {
+            AddWt(wts, &info);
         }
-        watchtowers[*n] = SplitLine(line);
-        *n+=1;
     }
-    
+
     free(line);
-    return watchtowers;
+    return wts;
+}
+
+// Parses the csv lines from p up to end into a new table.
+// One record per line, lines with fewer fields are skipped.
+static wt_table_t *ParseRange(char *p, char *end) {
+    // count lines to allocate once
+    int lines = 0;
+    char *q = p;
+    char *nl;
+    while (q < end && (nl = (char*)memchr(q, '\n', end - q)) != NULL) {
+        lines++;
+        q = nl + 1;
+    }
+    if (q < end) {
+        lines++;
+    }
+    wt_table_t *wts = CreateWts(lines);
+
+    wt_info_t info;
+    while (p < end) {
+        char *line_end = (char*)memchr(p, '\n', end - p);
+        if (line_end == NULL) {
+            line_end = end;
+        }
+        if (ParseWtLine(p, line_end, &info)) {
+            AddWt(wts, &info);
+        }
+        p = line_end + 1;
+    }
+    return wts;
+}
+
+// Thread body: parses one range into its own table
+static void *ParseRangeThread(void *arg) {
+    wt_range_t *range = (wt_range_t*)arg;
+    range->wts = ParseRange(range->start, range->end);
+    return NULL;
+}
+
+// Thread body: copies one range's table into its place in the merged table
+static void *CopyRangeThread(void *arg) {
+    wt_range_t *range = (wt_range_t*)arg;
+    wt_table_t *from = range->wts;
+    wt_table_t *to = range->merged;
+    int base = range->row_base;
+    int w;
+    memcpy(to->x + base, from->x, sizeof(double)*from->n);
+    memcpy(to->y + base, from->y, sizeof(double)*from->n);
+    memcpy(to->population + base, from->population, sizeof(int)*from->n);
+    for (w=0;w<from->n;w++) {
+        to->ID[base+w] = from->ID[w] + range->pool_base;
+        to->contact_name[base+w] = from->contact_name[w] + range->pool_base;
+        to->postcode[base+w] = range->postcode_map[from->postcode[w]];
+    }
+    memcpy(to->pool + range->pool_base, from->pool, from->pool_len);
+    return NULL;
+}
+
+// Runs fn on every range, one thread each, the calling thread taking the first
+static void RunRanges(wt_range_t *ranges, int n, void *(*fn)(void*)) {
+    pthread_t *ids;
+    if ( (ids = (pthread_t*)malloc(sizeof(pthread_t)*n)) == NULL ) {
+        printf("malloc() error\n");
+        exit(EXIT_FAILURE);
+    }
+    int i;
+    for (i=1;i<n;i++) {
+        if (pthread_create(&ids[i], NULL, fn, &ranges[i]) != 0) {
+            printf("pthread_create() error\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    fn(&ranges[0]);
+    for (i=1;i<n;i++) {
+        pthread_join(ids[i], NULL);
+    }
+    free(ids);
 }
 
-// Split each line into 6 components and store each in the struct pointer
-// Assuming the headings and their order is always the same
-// strtok usage idea from https://www.tutorialspoint.com/c_standard_library/c_function_strtok.htm
-wt_info_t *SplitLine(char *line) {
-    wt_info_t *info;
-    if ( (info = (wt_info_t*)malloc(sizeof(wt_info_t))) == NULL ) {
+//==============================================================================
+// Parses the csv lines from p up to end with n threads. The bytes are cut
+// into n ranges, each ending just after a newline, so every range holds
+// whole lines and is parsed into a table of its own. The tables are then
+// merged in range order, which gives the same rows in the same order as
+// parsing the lines one after another. Postcodes are interned again range
+// by range, so they are numbered in order of first appearance, as they
+// would have been.
+//==============================================================================
+static wt_table_t *ParseRanges(char *p, char *end, int n) {
+    wt_range_t *ranges;
+    if ( (ranges = (wt_range_t*)malloc(sizeof(wt_range_t)*n)) == NULL ) {
         printf("malloc() error\n");
         exit(EXIT_FAILURE);
     }
-    char *token;
+    int i, k;
+    char *cut = p;
+    for (i=0;i<n;i++) {
+        ranges[i].start = cut;
+        if (i < n-1) {
+            char *at = p + (size_t)(end - p) / n * (i+1);
+            if (at < cut) {
+                at = cut;
+            }
+            char *nl = (char*)memchr(at, '\n', end - at);
+            cut = nl ? nl + 1 : end;
+        } else {
+            cut = end;
+        }
+        ranges[i].end = cut;
+    }
+    RunRanges(ranges, n, ParseRangeThread);
 
-    token = strtok(line, ",");
-    info->ID = OneString(token);
+    // lay out the merged table, with the merged postcodes at the front of
+    // its pool and each range's pool copied whole after them
+    int total = 0;
+    for (i=0;i<n;i++) {
+        total += ranges[i].wts->n;
+    }
+    wt_table_t *merged = CreateWts(total);
+    for (i=0;i<n;i++) {
+        wt_table_t *wts = ranges[i].wts;
+        if ( (ranges[i].postcode_map = (int*)malloc(sizeof(int)*(wts->num_postcodes+1))) == NULL ) {
+            printf("malloc() error\n");
+            exit(EXIT_FAILURE);
+        }
+        for (k=0;k<wts->num_postcodes;k++) {
+            ranges[i].postcode_map[k] = Intern(merged, wts->pool + wts->postcodes[k]);
+        }
+    }
+    int rows = 0;
+    size_t pool_len = merged->pool_len;
+    for (i=0;i<n;i++) {
+        ranges[i].merged = merged;
+        ranges[i].row_base = rows;
+        ranges[i].pool_base = pool_len;
+        rows += ranges[i].wts->n;
+        pool_len += ranges[i].wts->pool_len;
+    }
+    if (pool_len > merged->pool_size) {
+        merged->pool_size = pool_len;
+        if ( (merged->pool = (char*)realloc(merged->pool, merged->pool_size)) == NULL ) {
+            printf("realloc() error\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    merged->n = total;
+    merged->pool_len = pool_len;
+    RunRanges(ranges, n, CopyRangeThread);
+
+    for (i=0;i<n;i++) {
+        FreeWts(ranges[i].wts);
+        free(ranges[i].postcode_map);
+    }
+    free(ranges);
+    return merged;
+}
+
+// Maps the csv file and parses it in place, then copies each record into a
+// new table. The commas ending string fields are overwritten with '\0' so the
+// fields can be copied where they lie; the mapping is private, so the file
+// itself is never changed. It is unmapped once loaded, as the table holds
+// copies of everything needed. Returns NULL if the file cannot be opened.
+// With threads > 1, files big enough to be worth it are parsed by up to
+// that many threads, giving the same table.
+wt_table_t *MapWtFile(const char *path, int threads) {
+    int fd;
+    struct stat st;
+    if ((fd = open(path, O_RDONLY)) < 0) {
+        return NULL;
+    }
+    if (fstat(fd, &st) < 0) {
+        close(fd);
+        return NULL;
+    }
 
-    token = strtok(NULL, ",");
-    info->postcode = OneString(token);
+    char *map = NULL;
+    size_t map_len = st.st_size;
+    if (map_len > 0) {
+        map = (char*)mmap(NULL, map_len, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        if (map == MAP_FAILED) {
+            printf("mmap() error\n");
+            exit(EXIT_FAILURE);
+        }
+        madvise(map, map_len, threads > 1 ? MADV_WILLNEED : MADV_SEQUENTIAL);
+    }
+    close(fd);
 
-    token = strtok(NULL, ",");
-    info->population = atoi(token);
+    char *p = map;
+    char *end = map + map_len;
 
-    token = strtok(NULL, ",");
-    info->contact_name = OneString(token);
+    // first row which is just headings
+    char *nl = map_len ? (char*)memchr(p, '\n', end - p) : NULL;
+    p = nl ? nl + 1 : end;
 
-    token = strtok(NULL, ",");
-    info->x = atof(token);
+    // every thread gets at least MIN_RANGE_LEN bytes
+    size_t max_ranges = (end - p) / MIN_RANGE_LEN;
+    if (threads > (int)max_ranges) {
+        threads = (int)max_ranges;
+    }
+    wt_table_t *wts = threads > 1 ? ParseRanges(p, end, threads) : ParseRange(p, end);
+
+    if (map) {
+        munmap(map, map_len);
+    }
+    return wts;
+}
 
-    token = strtok(NULL, "\n");
-    info->y = atof(token);
-    
-    return info;
+//==============================================================================
+// Splits the csv line from p up to line_end into 6 components, assuming the
+// headings and their order is always the same, and fills in info.
+// The string fields are terminated in place, so info points into the line.
+// Returns 0, leaving info unset, if the line has fewer than 6 fields.
+//==============================================================================
+int ParseWtLine(char *p, char *line_end, wt_info_t *info) {
+    char *field[6];
+    char *comma[5];
+    int i;
+    field[0] = p;
+    for (i=0;i<5;i++) {
+        comma[i] = (char*)memchr(field[i], ',', line_end - field[i]);
+        if (comma[i] == NULL) {
+            return 0;
+        }
+        field[i+1] = comma[i] + 1;
+    }
+    *comma[0] = *comma[1] = *comma[3] = '\0';
+    info->ID = field[0];
+    info->postcode = field[1];
+    info->population = ParseInt(field[2], comma[2]);
+    info->contact_name = field[3];
+    info->x = ParseDouble(field[4], comma[4]);
+    info->y = ParseDouble(field[5], line_end);
+    return 1;
 }
 
-// Further string processing for string entries
-char *OneString(char *line) {
-    int len;
-    len = strlen(line);
-    char *temp;
-    if ( (temp = (char*)malloc(sizeof(char)*(len+1))) == NULL ) {
+// Exact powers of ten, for the fast path of ParseDouble
+static const double POW10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+// Parses the decimal number in s up to end, giving the same value as atof.
+// Plain decimals with at most 19 significant digits, whose digits fit in 53
+// bits and whose scale is within 10^22, are converted with one correctly
+// rounded multiply or divide. Anything else goes through strtod.
+double ParseDouble(const char *s, const char *end) {
+    const char *p = s;
+    while (p < end && (*p == ' ' || *p == '\t')) {
+        p++;
+    }
+    int neg = 0;
+    if (p < end && (*p == '-' || *p == '+')) {
+        neg = (*p == '-');
+        p++;
+    }
+    uint64_t m = 0;
+    int sig = 0, exp10 = 0, digits = 0;
+    for (;p < end && *p >= '0' && *p <= '9';p++, digits++) {
+        if (m || *p != '0') {
+            m = m*10 + (*p - '0');
+            sig++;
+        }
+    }
+    if (p < end && *p == '.') {
+        for (p++;p < end && *p >= '0' && *p <= '9';p++, digits++) {
+            if (m || *p != '0') {
+                m = m*10 + (*p - '0');
+                sig++;
+            }
+            exp10--;
+        }
+    }
+    int plain = digits > 0 && sig <= 19 &&
+        (p == end || *p == '\r' || *p == '\n' || *p == ' ' || *p == '\t');
+    if (plain && m <= ((uint64_t)1 << 53) && exp10 >= -22) {
+        double v = (double)m / POW10[-exp10];
+        return neg ? -v : v;
+    }
+
+    // slow path, strtod needs a terminated copy
+    char buf[MAX_NUM_LEN];
+    size_t len = end - s;
+    char *copy = len < MAX_NUM_LEN ? buf : (char*)malloc(len+1);
+    if (copy == NULL) {
         printf("malloc() error\n");
         exit(EXIT_FAILURE);
     }
-    strcpy(temp, line);
-    temp[len] = '\0';
-    return temp;
+    memcpy(copy, s, len);
+    copy[len] = '\0';
+    double v = strtod(copy, NULL);
+    if (copy != buf) {
+        free(copy);
+    }
+    return v;
 }
 
-// Outputs one watchtower information into a file
-void PrintWtInfo(FILE *file, wt_info_t *entry) {
+// Parses the integer in s up to end, giving the same value as atoi, which
+// is strtol's cast to an int. Like strtol, a value beyond the range of a
+// long saturates at LONG_MAX or LONG_MIN.
+int ParseInt(const char *s, const char *end) {
+    const char *p = s;
+    while (p < end && (*p == ' ' || *p == '\t')) {
+        p++;
+    }
+    int neg = 0;
+    if (p < end && (*p == '-' || *p == '+')) {
+        neg = (*p == '-');
+        p++;
+    }
+    // the magnitude is built in an unsigned long, where LONG_MIN fits
+    unsigned long limit = neg ? (unsigned long)LONG_MAX + 1 : LONG_MAX;
+    unsigned long v = 0;
+    for (;p < end && *p >= '0' && *p <= '9';p++) {
+        int d = *p - '0';
+        if (v > (limit - d) / 10) {
+            v = limit;
+            break;
+        }
+        v = v*10 + d;
+    }
+    long l = v > LONG_MAX ? LONG_MIN : neg ? -(long)v : (long)v;
+    return (int)l;
+}
+
+char *WtID(wt_table_t *wts, int w) {
+    return wts->pool + wts->ID[w];
+}
+
+char *WtPostcode(wt_table_t *wts, int w) {
+    return wts->pool + wts->postcodes[wts->postcode[w]];
+}
+
+char *WtContactName(wt_table_t *wts, int w) {
+    return wts->pool + wts->contact_name[w];
+}
+
+// Outputs watchtower w's information into a file
+void PrintWtInfo(FILE *file, wt_table_t *wts, int w) {
     fprintf(file, "Watchtower ID: %s, Postcode: %s, Population Served: %d, "
            "Watchtower Point of Contact Name: %s, x: %f, y: %f\n",
-    entry->ID,entry->postcode,entry->population,entry->contact_name,entry->x,entry->y);
+    WtID(wts, w),WtPostcode(wts, w),wts->population[w],WtContactName(wts, w),wts->x[w],wts->y[w]);
 }
 
-// Frees the string entries, watchtower entries and entire array
-void FreeWts(wt_info_t **watchtowers, int *n) {
-    int i;
-    for (i=0;i<*n;i++) {
-        wt_info_t *entry = watchtowers[i];
-        free(entry->ID);
-        free(entry->postcode);
-        free(entry->contact_name);
-        free(entry);
-    }
-    free(watchtowers);
+// Same as PrintWtInfo, through a writer. The line is rendered straight into
+// the writer's buffer rather than parsed from a format string each time.
+void WriteWtInfo(writer_t *writer, wt_table_t *wts, int w) {
+    WriteString(writer, "Watchtower ID: ");
+    WriteString(writer, WtID(wts, w));
+    WriteString(writer, ", Postcode: ");
+    WriteString(writer, WtPostcode(wts, w));
+    WriteString(writer, ", Population Served: ");
+    WriteInt(writer, wts->population[w]);
+    WriteString(writer, ", Watchtower Point of Contact Name: ");
+    WriteString(writer, WtContactName(wts, w));
+    WriteString(writer, ", x: ");
+    WriteFixed(writer, wts->x[w]);
+    WriteString(writer, ", y: ");
+    WriteFixed(writer, wts->y[w]);
+    WriteBytes(writer, "\n", 1);
+}
+
+// Frees the columns, the string pool and the table
+void FreeWts(wt_table_t *wts) {
+    free(wts->x);
+    free(wts->y);
+    free(wts->population);
+    free(wts->ID);
+    free(wts->contact_name);
+    free(wts->postcode);
+    free(wts->postcodes);
+    free(wts->intern);
+    free(wts->pool);
+    free(wts);
 }
\ No newline at end of file
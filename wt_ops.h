@@ -1,3 +1,11 @@
+#ifndef WT_OPS_H
+#define WT_OPS_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include "writer_ops.h"
+
+// One watchtower as parsed from a csv line, its strings pointing into the line
 typedef struct {
     char *ID;
     char *postcode;
@@ -7,14 +15,60 @@ typedef struct {
     double y;
 } wt_info_t;
 
+// Watchtowers stored column by column. The coordinates and populations
+// that classification and the population sums read sit in arrays of their
+// own, and the string columns are offsets into one pool of '\0' terminated
+// strings, in which each distinct postcode is stored only once.
+typedef struct {
+    int n;
+    int size;
+    double *x;
+    double *y;
+    int *population;
+    // offsets of each watchtower's ID and contact name in pool
+    size_t *ID;
+    size_t *contact_name;
+    // index of each watchtower's postcode in postcodes
+    int *postcode;
+    // the distinct postcodes, as offsets in pool
+    int num_postcodes;
+    int size_postcodes;
+    size_t *postcodes;
+    // open addressing hash table of postcode indices, -1 where empty
+    int *intern;
+    int intern_size;
+    char *pool;
+    size_t pool_len;
+    size_t pool_size;
+} wt_table_t;
+
+wt_table_t *CreateWts(int size);
+
+int AddWt(wt_table_t *wts, wt_info_t *info);
+
+void ClearWts(wt_table_t *wts);
+
 // realloc usage idea from https://people.eng.unimelb.edu.au/ammoffat/ppsaa/c/realloc.c
-wt_info_t **ReadWtInfo(FILE *file, int *n);
+wt_table_t *ReadWtInfo(FILE *file);
+
+wt_table_t *MapWtFile(const char *path, int threads);
+
+int ParseWtLine(char *p, char *line_end, wt_info_t *info);
+
+double ParseDouble(const char *s, const char *end);
+
+int ParseInt(const char *s, const char *end);
+
+char *WtID(wt_table_t *wts, int w);
+
+char *WtPostcode(wt_table_t *wts, int w);
+
+char *WtContactName(wt_table_t *wts, int w);
 
-// strtok usage idea from https://www.tutorialspoint.com/c_standard_library/c_function_strtok.htm
-wt_info_t *SplitLine(char *line);
+void PrintWtInfo(FILE *file, wt_table_t *wts, int w);
 
-char *OneString(char *line);
+void WriteWtInfo(writer_t *writer, wt_table_t *wts, int w);
 
-void PrintWtInfo(FILE *file, wt_info_t *entry);
+void FreeWts(wt_table_t *wts);
 
-void FreeWts(wt_info_t **watchtowers, int *n);
\ No newline at end of file
+#endif